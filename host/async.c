@@ -0,0 +1,178 @@
+/**
+ * --------------------------------------------------------------------------------------------+
+ * @desc        Asynchronous command queue on the panel emulator, drained by a worker thread
+ * --------------------------------------------------------------------------------------------+
+ *
+ * @file        async.c
+ * @tested      Linux x86-64 (gcc, pthreads)
+ *
+ * @depend      ili9341.h, ili9341_queue.h, ili9341_drain.h, ili9341_emu.h
+ * --------------------------------------------------------------------------------------------+
+ * @usage       async
+ *
+ * Draws the same scene directly and through the queue, and fails if the images differ, the
+ * completion callback did not run exactly once or a control line changed during a transfer.
+ * The main loop stands in for a 1 kHz sensor loop: it never waits for the panel, commands that
+ * do not fit into the ring are retried on the next pass.
+ */
+#include <stdio.h>
+#include <time.h>
+#include "ili9341.h"
+#include "ili9341_queue.h"
+#include "ili9341_drain.h"
+#include "ili9341_emu.h"
+
+/** @var Emulated panel, too large for the stack */
+static ili9341_emu_t emu;
+
+/** @var Driver instance and its queue */
+static ili9341_t lcd;
+static ili9341_queue_t queue;
+
+/** @var 32x32 row-major test bitmap */
+static uint8_t bitmap[32 * 32 / 8];
+
+/** @var Completion callback calls, written by the worker */
+static volatile unsigned callbacks;
+
+/** @const Scene step count, pixels and text included */
+#define STEPS 108
+
+static double _now_us (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void _done (void *arg)
+{
+  (void) arg;
+  callbacks++;
+}
+
+/**
+ * @desc    Draws one step of the scene, directly or through the queue
+ *
+ * @param   unsigned step
+ * @param   bool queued
+ *
+ * @return  char ILI9341_ERROR if the queue was full
+ */
+static char _scene_step (unsigned step, bool queued)
+{
+  static const char text[] = "Async 1 kHz";
+
+  if (step == 0) {
+    return queued ? ili9341_queue_clear_screen(&queue, ILI9341_BLACK)
+                  : (ili9341_clear_screen(&lcd, ILI9341_BLACK), ILI9341_SUCCESS);
+  } else if (step == 1) {
+    return queued ? ili9341_queue_draw_gradient_rect(&queue, 0, 0, 240, 60, ILI9341_RGB565(31, 0, 0), ILI9341_RGB565(0, 0, 31), true)
+                  : ili9341_draw_gradient_rect(&lcd, 0, 0, 240, 60, ILI9341_RGB565(31, 0, 0), ILI9341_RGB565(0, 0, 31), true);
+  } else if (step == 2) {
+    return queued ? ili9341_queue_draw_rect(&queue, 20, 80, 200, 60, ILI9341_RGB565(0, 20, 31))
+                  : ili9341_draw_rect(&lcd, 20, 80, 200, 60, ILI9341_RGB565(0, 20, 31));
+  } else if (step == 3) {
+    return queued ? ili9341_queue_draw_line(&queue, 0, 239, 150, 319, ILI9341_WHITE)
+                  : (ili9341_draw_line(&lcd, 0, 239, 150, 319, ILI9341_WHITE), ILI9341_SUCCESS);
+  } else if (step == 4) {
+    return queued ? ili9341_queue_draw_bitmap(&queue, 100, 200, bitmap, 32, 32, ILI9341_WHITE, ILI9341_BLACK)
+                  : ili9341_draw_bitmap(&lcd, 100, 200, bitmap, 32, 32, ILI9341_WHITE, ILI9341_BLACK);
+  } else if (step == 5) {
+    if (queued) {
+      return ili9341_queue_draw_string_fast(&queue, 10, 100, text, ILI9341_WHITE, 2, ILI9341_BLACK);
+    }
+    ili9341_set_position(&lcd, 10, 100);
+    ili9341_draw_string_fast(&lcd, (char *) text, ILI9341_WHITE, 2, ILI9341_BLACK);
+    return ILI9341_SUCCESS;
+  }
+  // a diagonal of single pixels, far more commands than the ring holds
+  step -= 6;
+  return queued ? ili9341_queue_draw_pixel(&queue, 20 + step, 250 + step / 2, ILI9341_RGB565(0, 63, 0))
+                : ili9341_draw_pixel(&lcd, 20 + step, 250 + step / 2, ILI9341_RGB565(0, 63, 0));
+}
+
+/**
+ * @desc    Main function
+ *
+ * @param   void
+ *
+ * @return  int 0 on success, 1 on mismatch
+ */
+int main(void)
+{
+  ili9341_drain_t drain;
+  ili9341_fence_t fence;
+  unsigned step = 0;
+  unsigned passes = 0;
+  unsigned retries = 0;
+  double sync_us, start, t, max_call_us = 0;
+  uint32_t crc_sync, crc_async;
+
+  for (unsigned i = 0; i < sizeof(bitmap); i++) {
+    bitmap[i] = (uint8_t) (i * 37 + (i >> 2));
+  }
+
+  // reference, drawn directly
+  ili9341_emu_init(&emu);
+  ili9341_emu_set_deferred(&emu, true);
+  ili9341_ctx_init(&lcd, ili9341_emu_intf(&emu));
+  ili9341_init(&lcd);
+  start = _now_us();
+  for (unsigned i = 0; i < STEPS; i++) {
+    _scene_step(i, false);
+  }
+  ili9341_barrier(&lcd);
+  sync_us = _now_us() - start;
+  crc_sync = ili9341_emu_crc32(&emu);
+
+  // same scene through the queue
+  ili9341_emu_init(&emu);
+  ili9341_emu_set_deferred(&emu, true);
+  ili9341_ctx_init(&lcd, ili9341_emu_intf(&emu));
+  ili9341_init(&lcd);
+  ili9341_queue_init(&queue, &lcd);
+  if (ili9341_drain_start(&drain, &queue) != ILI9341_SUCCESS) {
+    fprintf(stderr, "cannot start the drain thread\n");
+    return 1;
+  }
+
+  // every pass of the loop queues what fits and moves on
+  while (step <= STEPS + 1) {
+    t = _now_us();
+    if (step < STEPS) {
+      if (_scene_step(step, true) == ILI9341_SUCCESS) {
+        step++;
+      } else {
+        retries++;
+      }
+    } else if (step == STEPS) {
+      step += (ili9341_queue_callback(&queue, _done, NULL) == ILI9341_SUCCESS);
+    } else {
+      step += (ili9341_queue_fence(&queue, &fence) == ILI9341_SUCCESS);
+    }
+    t = _now_us() - t;
+    if (t > max_call_us) {
+      max_call_us = t;
+    }
+    ili9341_drain_kick(&drain);
+    passes++;
+  }
+  while (!ili9341_queue_fence_done(&queue, fence)) {
+    passes++;
+  }
+  crc_async = ili9341_emu_crc32(&emu);
+  ili9341_drain_stop(&drain);
+
+  printf("direct: %.1f us blocked, crc32 %08x\n", sync_us, (unsigned) crc_sync);
+  printf("queued: %.2f us longest call, %u loop passes, %u full-ring retries, crc32 %08x\n",
+         max_call_us, passes, retries, (unsigned) crc_async);
+  printf("callbacks %u, barrier violations %u\n", callbacks, (unsigned) emu.stats.barrier_violations);
+
+  if (crc_sync != crc_async || callbacks != 1 || emu.stats.barrier_violations) {
+    printf("FAIL\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,1000 @@
+/**
+ * --------------------------------------------------------------------------------------------+
+ * @desc        Bus-cost benchmark of the ILI9341 primitives on the panel emulator
+ * --------------------------------------------------------------------------------------------+
+ *
+ * @file        bench.c
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341.h, ili9341_queue.h, ili9341_pixel.h, ili9341_emu.h
+ * --------------------------------------------------------------------------------------------+
+ * @usage       bench              print the cost table
+ *              bench -w FILE      print and save the counters as a baseline
+ *              bench -c FILE      print and fail if the hook calls or wire bytes of a case grew
+ *                                 or its image changed
+ *
+ * Every case runs on a freshly initialized panel. Counters describe a single run of the case,
+ * the time column is the average of repeated runs and is informative only. The panel reads
+ * sendbuf buffers at the barrier like a DMA transfer would, so a buffer reused too early shows
+ * up as an image change and a control line change during a transfer as a regression. Every
+ * case is also drawn once with sendbuf reading its buffers at once, and must give the same image.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ili9341.h"
+#include "ili9341_queue.h"
+#include "ili9341_console.h"
+#include "ili9341_font.h"
+#include "ili9341_pixel.h"
+#include "ili9341_emu.h"
+
+/** @var Emulated panel, too large for the stack */
+static ili9341_emu_t emu;
+
+/** @var Scratch pixel buffer for the bitmap cases */
+static uint8_t render_buf[64 * 64 * 2];
+
+/** @var 32x32 row-major test bitmap, generated at start-up */
+static uint8_t bitmap[32 * 32 / 8];
+
+/** @var 64x64 RGB888 test image, generated at start-up */
+static uint8_t image_rgb888[64 * 64 * 3];
+
+/** @const Label used by the text cases */
+static char label[] = "Speed 123 km/h, Temp 45.6 C";
+
+/** @struct Result of a single case */
+typedef struct {
+  uint32_t sendbyte;
+  uint32_t sendbuf;
+  uint32_t sendbuf_bytes;
+  uint32_t commit;
+  uint32_t barrier;
+  uint32_t dc_toggles;
+  uint32_t wire_bytes;
+  uint32_t crc;
+  uint32_t violations;
+  double us;
+} bench_result_t;
+
+/** @struct Benchmark case */
+typedef struct {
+  const char *name;
+  void (*run)(void);
+} bench_case_t;
+
+// CASES
+// ---------------------------------------------------------------
+static void _clear_screen (void)
+{
+  ILI9341_ClearScreen(ILI9341_RGB565(0, 20, 31));
+}
+
+static void _draw_rect (void)
+{
+  ILI9341_DrawRect(40, 60, 100, 100, ILI9341_WHITE);
+}
+
+static void _draw_pixels (void)
+{
+  for (uint16_t i = 0; i < 100; i++) {
+    ILI9341_DrawPixel(i * 2, 10 + i, ILI9341_WHITE);
+  }
+}
+
+static void _draw_line_shallow (void)
+{
+  ILI9341_DrawLine(0, 239, 40, 100, ILI9341_WHITE);
+}
+
+static void _draw_line_steep (void)
+{
+  ILI9341_DrawLine(100, 160, 0, 319, ILI9341_WHITE);
+}
+
+static void _draw_line_diagonal (void)
+{
+  ILI9341_DrawLine(0, 200, 0, 200, ILI9341_WHITE);
+}
+
+static void _draw_line_hv (void)
+{
+  ILI9341_DrawLineHorizontal(10, 229, 12, ILI9341_WHITE);
+  ILI9341_DrawLineVertical(12, 10, 309, ILI9341_WHITE);
+}
+
+static void _draw_string (void)
+{
+  ILI9341_SetPosition(2, 100);
+  ILI9341_DrawString(label, ILI9341_WHITE, X1);
+}
+
+static void _draw_string_fast (void)
+{
+  ILI9341_SetPosition(2, 100);
+  ILI9341_DrawStringFast(label, ILI9341_WHITE, 1, ILI9341_BLACK);
+}
+
+static void _draw_string_fast_x2 (void)
+{
+  ILI9341_SetPosition(2, 100);
+  ILI9341_DrawStringFast("12:34:56", ILI9341_WHITE, 2, ILI9341_BLACK);
+}
+
+static void _bitmap_pattern (void)
+{
+  ILI9341_RenderBitmap(render_buf, bitmap, 32, 32, ILI9341_WHITE, ILI9341_BLACK);
+  ILI9341_WritePatternRect(render_buf, 32 * 32 * 2, 100, 100, 32, 32);
+}
+
+static void _bitmap_scaled_pattern (void)
+{
+  ILI9341_RenderScaledBitmap(render_buf, 64, 64, bitmap, 32, 32, ILI9341_WHITE, ILI9341_BLACK);
+  ILI9341_WritePatternRect(render_buf, 64 * 64 * 2, 80, 80, 64, 64);
+}
+
+static void _bitmap_scaled_col_pattern (void)
+{
+  ILI9341_RenderScaledBitmapColMajor(render_buf, 48, 48, bitmap, 32, 32, ILI9341_WHITE, ILI9341_BLACK);
+  ILI9341_WritePatternRect(render_buf, 48 * 48 * 2, 80, 80, 48, 48);
+}
+
+static void _gradient_rect (void)
+{
+  ILI9341_DrawGradientRect(20, 40, 200, 100, ILI9341_RGB565(31, 0, 0), ILI9341_RGB565(0, 0, 31), true);
+}
+
+static void _bitmap_stream (void)
+{
+  ILI9341_DrawBitmap(100, 100, bitmap, 32, 32, ILI9341_WHITE, ILI9341_BLACK);
+}
+
+static void _bitmap_scaled_stream (void)
+{
+  ILI9341_DrawScaledBitmap(80, 80, 64, 64, bitmap, 32, 32, ILI9341_WHITE, ILI9341_BLACK);
+}
+
+static void _bitmap_scaled_stream_full (void)
+{
+  ILI9341_DrawScaledBitmapColMajor(0, 40, 240, 240, bitmap, 32, 32, ILI9341_WHITE, ILI9341_BLACK);
+}
+
+static void _image_rgb888 (void)
+{
+  ili9341_draw_image(ili9341_default(), 80, 80, 64, 64, image_rgb888, ILI9341_IMAGE_RGB888);
+}
+
+/** @var Off-screen frame for the framebuffer cases */
+static uint8_t framebuffer[ILI9341_FB_SIZE];
+
+static void _fb_begin (void)
+{
+  memset(framebuffer, 0, sizeof(framebuffer));
+  ILI9341_AttachFramebuffer(framebuffer);
+}
+
+static void _fb_end (void)
+{
+  ILI9341_Flush();
+  ILI9341_AttachFramebuffer(NULL);
+}
+
+static void _fb_draw_pixels (void)
+{
+  _fb_begin();
+  _draw_pixels();
+  _fb_end();
+}
+
+static void _fb_draw_string (void)
+{
+  _fb_begin();
+  _draw_string();
+  _fb_end();
+}
+
+static void _fb_draw_line_diagonal (void)
+{
+  _fb_begin();
+  _draw_line_diagonal();
+  _fb_end();
+}
+
+static void _fb_overdraw (void)
+{
+  _fb_begin();
+  for (uint16_t i = 0; i < 8; i++) {
+    ILI9341_DrawRect(40 + i * 4, 60 + i * 4, 100, 100, ILI9341_RGB565((i * 4), 0, (31 - i * 4)));
+  }
+  _draw_string_fast();
+  _fb_end();
+}
+
+/** @var Copy of the panel for the frame-diff case */
+static uint8_t prev_frame[ILI9341_FB_SIZE];
+
+/**
+ * @desc    Redraws a whole gauge screen, as immediate-mode dashboards do every frame
+ *
+ * @param   uint16_t value 0 to 200
+ *
+ * @return  void
+ */
+static void _dashboard (uint16_t value)
+{
+  char text[] = "Speed 000 km/h";
+
+  text[6] = '0' + value / 100;
+  text[7] = '0' + value / 10 % 10;
+  text[8] = '0' + value % 10;
+  ILI9341_ClearScreen(ILI9341_RGB565(2, 4, 6));
+  ILI9341_DrawRect(10, 10, 220, 30, ILI9341_RGB565(4, 8, 12));
+  ILI9341_SetPosition(20, 20);
+  ILI9341_DrawStringFast(text, ILI9341_WHITE, 1, ILI9341_RGB565(4, 8, 12));
+  // bar gauge and needle
+  ILI9341_DrawRect(20, 60, 200, 20, ILI9341_RGB565(6, 12, 6));
+  ILI9341_DrawGradientRect(20, 60, value, 20, ILI9341_RGB565(0, 63, 0), ILI9341_RGB565(31, 0, 0), true);
+  ILI9341_DrawLine(120, 20 + value, 200, 120, ILI9341_WHITE);
+  for (uint16_t i = 0; i < 8; i++) {
+    ILI9341_DrawBitmap(20 + i * 26, 260, bitmap, 24, 24, ILI9341_WHITE, ILI9341_RGB565(2, 4, 6));
+  }
+}
+
+/**
+ * @desc    Draws a dashboard frame, then counts only the refresh of the next one
+ *
+ * @param   bool diff compare against the previous frame
+ *
+ * @return  void
+ */
+static void _dashboard_frames (bool diff)
+{
+  _fb_begin();
+  _dashboard(40);
+  ILI9341_Flush();
+  if (diff) {
+    ILI9341_Barrier();
+    memcpy(prev_frame, framebuffer, sizeof(prev_frame));
+    ILI9341_AttachPrevFrame(prev_frame);
+  }
+  ili9341_emu_complete(&emu);
+  ili9341_emu_reset_stats(&emu);
+  _dashboard(42);
+  _fb_end();
+  ILI9341_AttachPrevFrame(NULL);
+}
+
+static void _fb_dashboard_full (void)
+{
+  _dashboard_frames(false);
+}
+
+static void _fb_dashboard_diff (void)
+{
+  _dashboard_frames(true);
+}
+
+// log view between a 20-row status bar and a 20-row footer, 35 text lines of 8 rows
+static void _log_line (uint16_t y)
+{
+  ILI9341_SetPosition(2, y);
+  ILI9341_DrawStringFast(label, ILI9341_WHITE, 1, ILI9341_BLACK);
+}
+
+static void _log_fill (void)
+{
+  for (uint16_t i = 0; i < 35; i++) {
+    _log_line(20 + i * 8);
+  }
+  ili9341_emu_complete(&emu);
+  ili9341_emu_reset_stats(&emu);
+}
+
+static void _log_scroll_redraw (void)
+{
+  _log_fill();
+  // every line moves up, the region is drawn again
+  ILI9341_DrawRect(0, 20, 240, 280, ILI9341_BLACK);
+  for (uint16_t i = 0; i < 35; i++) {
+    _log_line(20 + i * 8);
+  }
+}
+
+static void _log_scroll_hw (void)
+{
+  ILI9341_SetScrollArea(20, 20);
+  _log_fill();
+  // VSSAD moves the lines, only the new one is cleared and drawn
+  ILI9341_Scroll(8);
+  ILI9341_DrawRect(0, 292, 240, 8, ILI9341_BLACK);
+  _log_line(292);
+}
+
+/** @var Built-in font and the runs of bench_font.bdf converted by fontconv (bench_fonts.c) */
+extern const ili9341_font_t font_prop_x2, font_prop_x3_rle, font_aa4_x2_5, font_bdf_kana;
+
+/**
+ * @var Text of the BDF font: ASCII, Latin Extended-A and kana runs, a glyph of the BDF font left out of
+ *      the runs, a codepoint it does not have and a malformed byte
+ */
+static const char bdf_text[] = "\xc5\x81\xc5\x82" "a \xc4\x85\xc5\xbc zA? \xe3\x82\xa2\xe3\x82\xab\xe3\x83\xb3 "
+                               "\xe3\x81\x82 \xc3\xa9\xe2\x98\x83\xff";
+
+static void _text_fixed_x2 (void)
+{
+  ILI9341_SetPosition(2, 100);
+  ILI9341_DrawStringFast("Speed 123 km/h", ILI9341_WHITE, 2, ILI9341_BLACK);
+}
+
+static void _text_prop_x2 (void)
+{
+  ILI9341_SetPosition(2, 100);
+  ili9341_draw_text(ili9341_default(), &font_prop_x2, "Speed 123 km/h", ILI9341_WHITE, ILI9341_BLACK);
+}
+
+static void _text_utf8_x2 (void)
+{
+  // Polish text, the letters the font does not have drawn with its fallback glyph
+  ILI9341_SetPosition(2, 100);
+  ili9341_draw_text(ili9341_default(), &font_prop_x2, "Za\xc5\xbc\xc3\xb3\xc5\x82\xc4\x87 12 km/h", ILI9341_WHITE, ILI9341_BLACK);
+}
+
+static void _text_utf8_bdf (void)
+{
+  ILI9341_SetPosition(2, 100);
+  ili9341_draw_text(ili9341_default(), &font_bdf_kana, bdf_text, ILI9341_WHITE, ILI9341_BLACK);
+}
+
+/**
+ * @desc    Draws the text of the BDF font a character at a time, every glyph looked up without the
+ *          run of the one before
+ *
+ * @param   void
+ *
+ * @return  void
+ */
+static void _text_utf8_bdf_chars (void)
+{
+  const char *str = bdf_text;
+  char one[5];
+
+  ILI9341_SetPosition(2, 100);
+  while (*str) {
+    const char *start = str;
+    ili9341_utf8_next(&str);
+    memcpy(one, start, str - start);
+    one[str - start] = '\0';
+    ili9341_draw_text(ili9341_default(), &font_bdf_kana, one, ILI9341_WHITE, ILI9341_BLACK);
+  }
+}
+
+static void _text_fixed_x3 (void)
+{
+  ILI9341_SetPosition(2, 100);
+  ILI9341_DrawStringFast("Temp 45.6 C", ILI9341_WHITE, 3, ILI9341_BLACK);
+}
+
+static void _text_prop_x3_rle (void)
+{
+  ILI9341_SetPosition(2, 100);
+  ili9341_draw_text(ili9341_default(), &font_prop_x3_rle, "Temp 45.6 C", ILI9341_WHITE, ILI9341_BLACK);
+}
+
+static void _text_aa4 (void)
+{
+  ILI9341_SetPosition(2, 100);
+  ili9341_draw_text(ili9341_default(), &font_aa4_x2_5, "Temp 45.6 C", ILI9341_WHITE, ILI9341_RGB565(0, 8, 16));
+}
+
+/** @var Glyph cache pool, 16 cells of scale 2 */
+static uint32_t glyph_pool[16 * ILI9341_GLYPH_SLOT_SIZE(2) / 4];
+
+/**
+ * @desc    Ticks a clock label ten seconds, as status bars redraw numbers
+ *
+ * @param   void
+ *
+ * @return  void
+ */
+static void _clock_ticks (void)
+{
+  char text[] = "12:34:50";
+
+  for (uint16_t i = 0; i < 10; i++) {
+    text[7] = '0' + i;
+    ILI9341_SetPosition(2, 100);
+    ILI9341_DrawStringFast(text, ILI9341_WHITE, 2, ILI9341_BLACK);
+  }
+}
+
+static void _glyph_cache_clock (void)
+{
+  ILI9341_AttachGlyphCache((uint8_t *) glyph_pool, sizeof(glyph_pool), 2);
+  _clock_ticks();
+  ILI9341_AttachGlyphCache(NULL, 0, 0);
+}
+
+static void _console_scroll (void)
+{
+  ili9341_console_t con;
+
+  ili9341_console_init(&con, ili9341_default(), 20, 20, 1, ILI9341_WHITE, ILI9341_BLACK);
+  for (uint16_t i = 0; i < 35; i++) {
+    ili9341_console_printf(&con, "%s\n", label);
+  }
+  ili9341_emu_complete(&emu);
+  ili9341_emu_reset_stats(&emu);
+  // the newline past the last line scrolls, then the line is written
+  ili9341_console_printf(&con, "%s\n", label);
+}
+
+// synthetic damage, small areas spread the way widgets, text cells and sparse plots are
+static void _fb_damage_row (void)
+{
+  _fb_begin();
+  for (uint16_t i = 0; i < 30; i++) {
+    ILI9341_DrawRect(i * 8, 150, 7, 8, ILI9341_WHITE);
+  }
+  _fb_end();
+}
+
+static void _fb_damage_corners (void)
+{
+  _fb_begin();
+  ILI9341_DrawRect(0, 0, 12, 12, ILI9341_WHITE);
+  ILI9341_DrawRect(228, 0, 12, 12, ILI9341_WHITE);
+  ILI9341_DrawRect(0, 308, 12, 12, ILI9341_WHITE);
+  ILI9341_DrawRect(228, 308, 12, 12, ILI9341_WHITE);
+  _fb_end();
+}
+
+static void _fb_damage_grid (void)
+{
+  _fb_begin();
+  for (uint16_t i = 0; i < 16; i++) {
+    ILI9341_DrawRect(10 + (i % 4) * 60, 20 + (i / 4) * 80, 16, 10, ILI9341_WHITE);
+  }
+  _fb_end();
+}
+
+static void _fb_damage_scattered (void)
+{
+  uint32_t seed = 12345;
+
+  _fb_begin();
+  for (uint16_t i = 0; i < 50; i++) {
+    seed = seed * 1103515245 + 12345;
+    ILI9341_DrawRect((seed >> 8) % 236, (seed >> 16) % 316, 4, 4, ILI9341_WHITE);
+  }
+  _fb_end();
+}
+
+static void _overdraw (void)
+{
+  for (uint16_t i = 0; i < 8; i++) {
+    ILI9341_DrawRect(40 + i * 4, 60 + i * 4, 100, 100, ILI9341_RGB565((i * 4), 0, (31 - i * 4)));
+  }
+  _draw_string_fast();
+}
+
+/** @var Queue of the band cases, the frame it records and the 240x16 strip it is drawn through */
+static ili9341_queue_t frame;
+static ili9341_qcmd_t frame_cmds[64];
+static uint8_t strip[ILI9341_STRIP_SIZE(16)];
+
+/**
+ * @desc    Starts recording an empty frame for ili9341_queue_draw_bands
+ *
+ * @param   void
+ *
+ * @return  void
+ */
+static void _band_begin (void)
+{
+  ili9341_queue_init(&frame, ili9341_default());
+  ili9341_queue_record_frame(&frame, frame_cmds, sizeof(frame_cmds) / sizeof(frame_cmds[0]));
+}
+
+static void _band_overdraw (void)
+{
+  _band_begin();
+  for (uint16_t i = 0; i < 8; i++) {
+    ili9341_queue_draw_rect(&frame, 40 + i * 4, 60 + i * 4, 100, 100, ILI9341_RGB565((i * 4), 0, (31 - i * 4)));
+  }
+  ili9341_queue_draw_string_fast(&frame, 2, 100, label, ILI9341_WHITE, 1, ILI9341_BLACK);
+  ili9341_queue_draw_bands(&frame, strip, 16, ILI9341_BLACK);
+}
+
+static void _band_dashboard (void)
+{
+  _band_begin();
+  // more commands than the ring holds
+  for (uint16_t i = 0; i < 24; i++) {
+    ili9341_queue_draw_rect(&frame, 10 + (i % 4) * 60, 20 + (i / 4) * 50, 40, 8, ILI9341_RGB565(i, (63 - 2 * i), (31 - i)));
+    ili9341_queue_draw_pixel(&frame, 30 + (i % 4) * 60, 32 + (i / 4) * 50, ILI9341_WHITE);
+  }
+  ili9341_queue_draw_string_fast(&frame, 2, 2, label, ILI9341_WHITE, 1, ILI9341_BLACK);
+  ili9341_queue_draw_bands(&frame, strip, 16, ILI9341_BLACK);
+}
+
+static void _band_draw_line_diagonal (void)
+{
+  _band_begin();
+  ili9341_queue_draw_line(&frame, 0, 200, 0, 200, ILI9341_WHITE);
+  ili9341_queue_draw_bands(&frame, strip, 16, ILI9341_BLACK);
+}
+
+/**
+ * @desc    Direct gradient whose last stream buffer is still in flight when drawing moves off-screen
+ *
+ * @param   void
+ *
+ * @return  void
+ */
+static void _handoff_gradient (void)
+{
+  ILI9341_DrawGradientRect(0, 0, 16, 1, ILI9341_RGB565(31, 0, 0), ILI9341_RGB565(0, 0, 31), true);
+}
+
+static void _fb_after_direct (void)
+{
+  _handoff_gradient();
+  _fb_begin();
+  ILI9341_DrawGradientRect(0, 40, 16, 1, ILI9341_RGB565(0, 63, 0), ILI9341_WHITE, true);
+  _fb_end();
+}
+
+static void _band_after_direct (void)
+{
+  _handoff_gradient();
+  _band_begin();
+  ili9341_queue_draw_gradient_rect(&frame, 0, 40, 16, 1, ILI9341_RGB565(0, 63, 0), ILI9341_WHITE, true);
+  ili9341_queue_draw_bands(&frame, strip, 16, ILI9341_BLACK);
+}
+
+static const bench_case_t cases[] = {
+  { "ClearScreen",              _clear_screen },
+  { "DrawRect_100x100",         _draw_rect },
+  { "DrawPixel_x100",           _draw_pixels },
+  { "DrawLine_shallow",         _draw_line_shallow },
+  { "DrawLine_steep",           _draw_line_steep },
+  { "DrawLine_diagonal",        _draw_line_diagonal },
+  { "DrawLineHorizVert",        _draw_line_hv },
+  { "DrawString_27ch",          _draw_string },
+  { "DrawStringFast_27ch",      _draw_string_fast },
+  { "DrawStringFast_x2_8ch",    _draw_string_fast_x2 },
+  { "RenderBitmap+Pattern",     _bitmap_pattern },
+  { "RenderScaled2x+Pattern",   _bitmap_scaled_pattern },
+  { "RenderScaled1.5xCol+Pattern", _bitmap_scaled_col_pattern },
+  { "DrawGradientRect_200x100", _gradient_rect },
+  { "DrawBitmap_32x32",         _bitmap_stream },
+  { "DrawScaled2x_64x64",       _bitmap_scaled_stream },
+  { "DrawScaledCol_240x240",    _bitmap_scaled_stream_full },
+  { "DrawImage_rgb888_64x64",   _image_rgb888 },
+  { "Overdraw_8rects+text",     _overdraw },
+  { "FB_DrawPixel_x100",        _fb_draw_pixels },
+  { "FB_DrawLine_diagonal",     _fb_draw_line_diagonal },
+  { "FB_DrawString_27ch",       _fb_draw_string },
+  { "FB_Overdraw_8rects+text",  _fb_overdraw },
+  { "FB_Damage_row_30x8x8",     _fb_damage_row },
+  { "FB_Damage_corners_4",      _fb_damage_corners },
+  { "FB_Damage_grid_16",        _fb_damage_grid },
+  { "FB_Damage_scattered_50",   _fb_damage_scattered },
+  { "FB_Dashboard_full_frame",  _fb_dashboard_full },
+  { "FB_Dashboard_diff_frame",  _fb_dashboard_diff },
+  { "LogScroll_redraw_8rows",   _log_scroll_redraw },
+  { "LogScroll_hw_8rows",       _log_scroll_hw },
+  { "Console_scroll_line",      _console_scroll },
+  { "Clock_x2_10ticks",         _clock_ticks },
+  { "Text_fixed_x2_14ch",       _text_fixed_x2 },
+  { "Text_prop_x2_14ch",        _text_prop_x2 },
+  { "Text_utf8_x2_14ch",        _text_utf8_x2 },
+  { "Text_utf8_bdf_20ch",       _text_utf8_bdf },
+  { "Text_fixed_x3_11ch",       _text_fixed_x3 },
+  { "Text_prop_x3_rle_11ch",    _text_prop_x3_rle },
+  { "Text_aa4_x2.5_11ch",       _text_aa4 },
+  { "Clock_cached_x2_10ticks",  _glyph_cache_clock },
+  { "Band_DrawLine_diagonal",   _band_draw_line_diagonal },
+  { "Band_Overdraw_8rects+text", _band_overdraw },
+  { "Band_dashboard_49cmds",    _band_dashboard },
+  { "FB_after_direct_stream",   _fb_after_direct },
+  { "Band_after_direct_stream", _band_after_direct },
+};
+
+#define CASES_COUNT (sizeof(cases) / sizeof(cases[0]))
+
+// RUNNER
+// ---------------------------------------------------------------
+static double _now_us (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * @desc    Runs one case on a freshly initialized panel
+ *
+ * @param   const bench_case_t*
+ * @param   bench_result_t*
+ *
+ * @return  void
+ */
+static void _run_case (const bench_case_t *bc, bench_result_t *res)
+{
+  const ili9341_emu_stats_t *st = &emu.stats;
+  double start;
+  unsigned reps = 0;
+
+  ili9341_emu_init(&emu);
+  // sendbuf behaves like DMA, buffers are read at the barrier
+  ili9341_emu_set_deferred(&emu, true);
+  ili9341_set_hw_intf(ili9341_emu_intf(&emu));
+  ILI9341_Init();
+  ili9341_emu_reset_stats(&emu);
+
+  bc->run();
+  ili9341_emu_complete(&emu);
+
+  res->sendbyte = st->sendbyte_calls;
+  res->sendbuf = st->sendbuf_calls;
+  res->sendbuf_bytes = st->sendbuf_bytes;
+  res->commit = st->commit_calls;
+  res->barrier = st->barrier_calls;
+  res->dc_toggles = st->dc_toggles;
+  res->wire_bytes = st->cmd_bytes + st->data_bytes;
+  res->crc = ili9341_emu_crc32(&emu);
+  res->violations = st->barrier_violations;
+
+  // timing over repeated runs, at least 20 ms worth
+  start = _now_us();
+  do {
+    bc->run();
+    reps++;
+  } while (_now_us() - start < 20000.0);
+  res->us = (_now_us() - start) / reps;
+}
+
+/**
+ * @desc    Runs one case on a freshly initialized panel and returns its image
+ *
+ * @param   const bench_case_t*
+ * @param   bool deferred sendbuf buffers read at the barrier, else at once
+ *
+ * @return  uint32_t crc32 of the panel
+ */
+static uint32_t _image_crc (const bench_case_t *bc, bool deferred)
+{
+  ili9341_emu_init(&emu);
+  ili9341_emu_set_deferred(&emu, deferred);
+  ili9341_set_hw_intf(ili9341_emu_intf(&emu));
+  ILI9341_Init();
+  bc->run();
+  ili9341_emu_complete(&emu);
+  return ili9341_emu_crc32(&emu);
+}
+
+/**
+ * @desc    Checks that every case draws the same image whether sendbuf reads its buffers at once or
+ *          at the barrier, i.e. that no buffer is written while it may still be in flight
+ *
+ * @param   void
+ *
+ * @return  int number of regressions
+ */
+static int _check_deferred (void)
+{
+  int regressions = 0;
+
+  for (unsigned i = 0; i < CASES_COUNT; i++) {
+    uint32_t crc = _image_crc(&cases[i], false);
+    uint32_t crc_deferred = _image_crc(&cases[i], true);
+    if (crc != crc_deferred) {
+      printf("REGRESSION %s: image crc32 %08x with immediate sendbuf, %08x deferred\n", cases[i].name,
+             (unsigned) crc, (unsigned) crc_deferred);
+      regressions++;
+    }
+  }
+  return regressions;
+}
+
+/**
+ * @desc    Boots a fresh panel with the resumable init, waiting out every step
+ *
+ * @param   ILI9341_Boot profile
+ * @param   unsigned* steps number of waits
+ *
+ * @return  uint64_t microseconds waited until the first frame can be drawn
+ */
+static uint64_t _boot (ILI9341_Boot profile, unsigned *steps)
+{
+  uint64_t waited = 0;
+  uint32_t wait;
+
+  ili9341_emu_init(&emu);
+  ili9341_set_hw_intf(ili9341_emu_intf(&emu));
+  ILI9341_InitStart(profile);
+  *steps = 0;
+  while ((wait = ILI9341_InitStep()) != ILI9341_INIT_DONE) {
+    waited += wait;
+    (*steps)++;
+  }
+  return waited;
+}
+
+/**
+ * @desc    Compares the init profiles: the fast one must leave the panel in the same state
+ *
+ * @param   void
+ *
+ * @return  int number of regressions
+ */
+static int _check_boot (void)
+{
+  const ILI9341_Boot profiles[] = { ILI9341_BOOT_NORMAL, ILI9341_BOOT_FAST };
+  const char *names[] = { "normal", "fast" };
+  uint8_t regs[2][6];
+
+  for (unsigned i = 0; i < 2; i++) {
+    unsigned steps;
+    uint64_t waited = _boot(profiles[i], &steps);
+
+    printf("init %-6s %8llu us waiting in %u steps\n", names[i], (unsigned long long) waited, steps);
+    regs[i][0] = emu.madctl;
+    regs[i][1] = emu.colmod;
+    regs[i][2] = emu.sleeping;
+    regs[i][3] = emu.display_on;
+    regs[i][4] = emu.sc == 0 && emu.ec == ILI9341_SIZE_X;
+    regs[i][5] = emu.sp == 0 && emu.ep == ILI9341_SIZE_Y;
+  }
+  if (memcmp(regs[0], regs[1], sizeof(regs[0])) != 0) {
+    printf("REGRESSION init: fast profile leaves the panel in a different state\n");
+    return 1;
+  }
+  return 0;
+}
+
+/** @struct Input of the UTF-8 decoder and what it decodes to */
+typedef struct {
+  const char *str;
+  uint32_t cp[4];       // codepoints up to the terminating '\0'
+  uint8_t len[4];       // bytes each of them takes
+} utf8_case_t;
+
+/** @var Well-formed sequences of every length and at the limits, then malformed ones */
+static const utf8_case_t utf8_cases[] = {
+  { "",                                                          { 0 },                                  { 0 } },
+  { "a\xc3\xa9\xe3\x82\xa2\xf0\x9f\x98\x80",                     { 0x61, 0xe9, 0x30a2, 0x1f600 },        { 1, 2, 3, 4 } },
+  { "\xc2\x80\xdf\xbf\xe0\xa0\x80\xef\xbf\xbd",                  { 0x80, 0x7ff, 0x800, 0xfffd },         { 2, 2, 3, 3 } },
+  { "\xed\x9f\xbf\xee\x80\x80\xf0\x90\x80\x80\xf4\x8f\xbf\xbf",  { 0xd7ff, 0xe000, 0x10000, 0x10ffff },  { 3, 3, 4, 4 } },
+  // overlong
+  { "\xc0\xaf",                                                  { 0xfffd, 0xfffd },                     { 1, 1 } },
+  { "\xc1\xbf",                                                  { 0xfffd, 0xfffd },                     { 1, 1 } },
+  { "\xe0\x9f\xbf",                                              { 0xfffd, 0xfffd, 0xfffd },             { 1, 1, 1 } },
+  { "\xf0\x8f\xbf\xbf",                                          { 0xfffd, 0xfffd, 0xfffd, 0xfffd },     { 1, 1, 1, 1 } },
+  // surrogates
+  { "\xed\xa0\x80",                                              { 0xfffd, 0xfffd, 0xfffd },             { 1, 1, 1 } },
+  { "\xed\xbf\xbf",                                              { 0xfffd, 0xfffd, 0xfffd },             { 1, 1, 1 } },
+  // beyond U+10FFFF
+  { "\xf4\x90\x80\x80",                                          { 0xfffd, 0xfffd, 0xfffd, 0xfffd },     { 1, 1, 1, 1 } },
+  { "\xf5\x80\x80\x80",                                          { 0xfffd, 0xfffd, 0xfffd, 0xfffd },     { 1, 1, 1, 1 } },
+  // stray continuation and bytes that never occur
+  { "\x80" "a\xfe\xff",                                          { 0xfffd, 0x61, 0xfffd, 0xfffd },       { 1, 1, 1, 1 } },
+  // truncated, by the next character or by the '\0'
+  { "\xe3\x82" "a",                                              { 0xfffd, 0xfffd, 0x61 },               { 1, 1, 1 } },
+  { "\xf0\x9f\x98" " ",                                          { 0xfffd, 0xfffd, 0xfffd, 0x20 },       { 1, 1, 1, 1 } },
+  { "\xc3",                                                      { 0xfffd },                             { 1 } },
+  { "\xe3\x82",                                                  { 0xfffd, 0xfffd },                     { 1, 1 } },
+  { "\xf0\x9f\x98",                                              { 0xfffd, 0xfffd, 0xfffd },             { 1, 1, 1 } },
+};
+
+/**
+ * @desc    Checks the UTF-8 decoder: the codepoint and the bytes every sequence takes, and that it
+ *          stays at the terminating '\0'
+ *
+ * @param   void
+ *
+ * @return  int number of regressions
+ */
+static int _check_utf8 (void)
+{
+  int regressions = 0;
+
+  for (unsigned i = 0; i < sizeof(utf8_cases) / sizeof(utf8_cases[0]); i++) {
+    const utf8_case_t *c = &utf8_cases[i];
+    const char *str = c->str;
+
+    for (unsigned k = 0; k <= 4; k++) {
+      const char *start = str;
+      uint32_t cp = ili9341_utf8_next(&str);
+      // the codepoints, then the '\0' which takes no byte
+      uint32_t want = (k < 4) ? c->cp[k] : 0;
+      unsigned len = (k < 4) ? c->len[k] : 0;
+
+      if (cp != want || (unsigned) (str - start) != len) {
+        printf("REGRESSION utf8 case %u, codepoint %u: U+%04X in %u bytes, expected U+%04X in %u\n", i, k,
+               (unsigned) cp, (unsigned) (str - start), (unsigned) want, len);
+        regressions++;
+        break;
+      }
+      if (!want) {
+        break;
+      }
+    }
+  }
+  return regressions;
+}
+
+/**
+ * @desc    Checks the glyph lookup of a font with several codepoint runs: every codepoint of the BDF
+ *          font has its own glyph, in codepoint order, the others none, and the text draws the same
+ *          with the lookups starting in the run of the previous one as without
+ *
+ * @param   void
+ *
+ * @return  int number of regressions
+ */
+static int _check_font_runs (void)
+{
+  static const uint32_t has[] = { 0x20, 0x3f, 0x41, 0x4c, 0x61, 0x7a, 0x105, 0x141, 0x142, 0x17c,
+                                  0x3042, 0x30a2, 0x30ab, 0x30f3 };
+  // around the runs, beyond the first and the last, and a glyph of the BDF font not selected
+  static const uint32_t lacks[] = { 0x00, 0x1f, 0x21, 0x40, 0x7b, 0xe9, 0x104, 0x140, 0x143, 0x3041,
+                                    0x30f4, 0xfffd, 0x1f600 };
+  const bench_case_t runs = { "runs", _text_utf8_bdf }, chars = { "chars", _text_utf8_bdf_chars };
+  const ili9341_font_glyph_t *prev = NULL;
+  int regressions = 0;
+
+  for (unsigned i = 0; i < sizeof(has) / sizeof(has[0]); i++) {
+    const ili9341_font_glyph_t *g = ili9341_font_glyph(&font_bdf_kana, has[i]);
+    if (!g || g <= prev || g == &font_bdf_kana.glyphs[font_bdf_kana.fallback]) {
+      printf("REGRESSION font: wrong glyph of U+%04X\n", (unsigned) has[i]);
+      regressions++;
+    }
+    prev = g;
+  }
+  for (unsigned i = 0; i < sizeof(lacks) / sizeof(lacks[0]); i++) {
+    if (ili9341_font_glyph(&font_bdf_kana, lacks[i])) {
+      printf("REGRESSION font: glyph of U+%04X, which the font does not have\n", (unsigned) lacks[i]);
+      regressions++;
+    }
+  }
+  if (_image_crc(&runs, true) != _image_crc(&chars, true)) {
+    printf("REGRESSION font: text drawn at once differs from its characters drawn one by one\n");
+    regressions++;
+  }
+  return regressions;
+}
+
+/**
+ * @desc    Hook invocations of a result. Moving work between hooks (e.g. sendbyte to sendbuf)
+ *          is not a regression, growing the total is.
+ *
+ * @param   const bench_result_t*
+ *
+ * @return  uint32_t
+ */
+static uint32_t _hook_calls (const bench_result_t *res)
+{
+  return res->sendbyte + res->sendbuf + res->commit + res->barrier + res->dc_toggles;
+}
+
+/**
+ * @desc    Compares a result against a baseline line
+ *
+ * @param   const char* name
+ * @param   const bench_result_t* res
+ * @param   FILE* baseline
+ *
+ * @return  int number of regressions
+ */
+static int _check_case (const char *name, const bench_result_t *res, FILE *baseline)
+{
+  char line[256];
+  char bname[64];
+  bench_result_t b;
+  unsigned crc;
+
+  rewind(baseline);
+  while (fgets(line, sizeof(line), baseline)) {
+    if (sscanf(line, "%63s %u %u %u %u %u %u %u %x", bname, &b.sendbyte, &b.sendbuf,
+               &b.sendbuf_bytes, &b.commit, &b.barrier, &b.dc_toggles, &b.wire_bytes, &crc) != 9 ||
+        strcmp(bname, name) != 0) {
+      continue;
+    }
+    int regressions = 0;
+    if (res->violations) {
+      printf("REGRESSION %s: %u control line change(s) during a transfer\n", name,
+             (unsigned) res->violations);
+      regressions++;
+    }
+    if (_hook_calls(res) > _hook_calls(&b)) {
+      printf("REGRESSION %s: hook calls %u -> %u\n", name,
+             (unsigned) _hook_calls(&b), (unsigned) _hook_calls(res));
+      regressions++;
+    }
+    if (res->wire_bytes > b.wire_bytes) {
+      printf("REGRESSION %s: wire bytes %u -> %u\n", name,
+             (unsigned) b.wire_bytes, (unsigned) res->wire_bytes);
+      regressions++;
+    }
+    if (res->crc != crc) {
+      printf("REGRESSION %s: image crc32 %08x -> %08x\n", name, crc, (unsigned) res->crc);
+      regressions++;
+    }
+    return regressions;
+  }
+  printf("NOTE %s: not in baseline\n", name);
+  return 0;
+}
+
+/**
+ * @desc    Main function
+ *
+ * @param   int argc
+ * @param   char** argv
+ *
+ * @return  int 0 on success, 1 on regression or bad usage
+ */
+int main(int argc, char **argv)
+{
+  FILE *save = NULL;
+  FILE *baseline = NULL;
+  int regressions = 0;
+
+  if (argc == 3 && strcmp(argv[1], "-w") == 0) {
+    save = fopen(argv[2], "w");
+  } else if (argc == 3 && strcmp(argv[1], "-c") == 0) {
+    baseline = fopen(argv[2], "r");
+  } else if (argc != 1) {
+    fprintf(stderr, "usage: %s [-w baseline | -c baseline]\n", argv[0]);
+    return 1;
+  }
+  if (argc == 3 && save == NULL && baseline == NULL) {
+    perror(argv[2]);
+    return 1;
+  }
+
+  // deterministic test pattern
+  for (unsigned i = 0; i < sizeof(bitmap); i++) {
+    bitmap[i] = (uint8_t) (i * 37 + (i >> 2));
+  }
+  for (unsigned i = 0; i < sizeof(image_rgb888); i++) {
+    image_rgb888[i] = (uint8_t) (i * 13 + (i >> 5));
+  }
+
+  printf("%-24s %9s %8s %9s %7s %7s %7s %9s %9s %10s %8s\n", "case", "sendbyte", "sendbuf",
+         "buf_bytes", "commit", "barrier", "dc_tgl", "hooks", "wire_B", "us/op", "crc32");
+  for (unsigned i = 0; i < CASES_COUNT; i++) {
+    bench_result_t res;
+
+    _run_case(&cases[i], &res);
+    printf("%-24s %9u %8u %9u %7u %7u %7u %9u %9u %10.1f %08x\n", cases[i].name, res.sendbyte,
+           res.sendbuf, res.sendbuf_bytes, res.commit, res.barrier, res.dc_toggles,
+           _hook_calls(&res), res.wire_bytes, res.us, (unsigned) res.crc);
+    if (save) {
+      fprintf(save, "%s %u %u %u %u %u %u %u %08x\n", cases[i].name, res.sendbyte, res.sendbuf,
+              res.sendbuf_bytes, res.commit, res.barrier, res.dc_toggles, res.wire_bytes,
+              (unsigned) res.crc);
+    }
+    if (baseline) {
+      regressions += _check_case(cases[i].name, &res, baseline);
+    }
+  }
+
+  regressions += _check_deferred();
+  regressions += _check_utf8();
+  regressions += _check_font_runs();
+  regressions += _check_boot();
+
+  if (save) {
+    fclose(save);
+  }
+  if (baseline) {
+    fclose(baseline);
+    printf("%d regression(s)\n", regressions);
+  }
+  return regressions ? 1 : 0;
+}
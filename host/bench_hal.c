@@ -0,0 +1,104 @@
+/**
+ * --------------------------------------------------------------------------------------------+
+ * @desc        Per-byte hook overhead, runtime ili9341_hw_intf_t vs ILI9341_STATIC_HAL
+ * --------------------------------------------------------------------------------------------+
+ *
+ * @file        bench_hal.c
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341.h
+ * --------------------------------------------------------------------------------------------+
+ * @usage       bench_hal_runtime, bench_hal_static
+ *
+ * Built twice: once with the hooks behind ili9341_hw_intf_t and once with the library compiled
+ * against bench_static_hal.h. Both HALs only count the bytes and store them to a volatile
+ * register, so the reported time per byte is the overhead of the driver and the hook dispatch.
+ * Only sendbyte is provided, which keeps the fills on the per-pixel path where the dispatch cost
+ * matters most.
+ */
+#include <stdio.h>
+#include <time.h>
+#include "ili9341.h"
+
+uint32_t bench_hal_bytes;
+volatile uint8_t bench_hal_dr;
+
+#ifndef ILI9341_STATIC_HAL
+  static void _sendbyte (uint8_t byte)
+  {
+    bench_hal_bytes++;
+    bench_hal_dr = byte;
+  }
+
+  static const ili9341_hw_intf_t _hw_intf = {
+    .sendbyte = _sendbyte,
+  };
+  #define BENCH_HAL_NAME "runtime"
+#else
+  #define BENCH_HAL_NAME "static"
+#endif
+
+static double _now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void _clear_screen (void)
+{
+  ILI9341_ClearScreen(ILI9341_WHITE);
+}
+
+static void _draw_string_fast (void)
+{
+  ILI9341_SetPosition(2, 100);
+  ILI9341_DrawStringFast("Speed 123 km/h, Temp 45.6 C", ILI9341_WHITE, 1, ILI9341_BLACK);
+}
+
+static void _draw_line (void)
+{
+  ILI9341_DrawLine(0, 239, 0, 319, ILI9341_WHITE);
+}
+
+/**
+ * @desc    Runs a case for at least 100 ms and prints the time per byte sent
+ *
+ * @param   const char* name
+ * @param   void (*run)(void)
+ *
+ * @return  void
+ */
+static void _measure (const char *name, void (*run)(void))
+{
+  double start = _now_ns();
+  double elapsed;
+  uint32_t bytes = bench_hal_bytes;
+  unsigned reps = 0;
+
+  do {
+    run();
+    reps++;
+  } while ((elapsed = _now_ns() - start) < 100e6);
+  bytes = bench_hal_bytes - bytes;
+  printf("%-8s %-18s %10.3f us/op %8.3f ns/byte\n", BENCH_HAL_NAME, name,
+         elapsed / reps / 1e3, elapsed / bytes);
+}
+
+/**
+ * @desc    Main function
+ *
+ * @return  int
+ */
+int main(void)
+{
+#ifndef ILI9341_STATIC_HAL
+  ili9341_set_hw_intf(&_hw_intf);
+#endif
+  ILI9341_Init();
+
+  _measure("ClearScreen", _clear_screen);
+  _measure("DrawStringFast", _draw_string_fast);
+  _measure("DrawLine", _draw_line);
+  return 0;
+}
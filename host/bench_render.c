@@ -0,0 +1,360 @@
+/**
+ * --------------------------------------------------------------------------------------------+
+ * @desc        CPU time of the bitmap renderers and pixel conversion kernels
+ * --------------------------------------------------------------------------------------------+
+ *
+ * @file        bench_render.c
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341.h, ili9341_pixel.h
+ * --------------------------------------------------------------------------------------------+
+ * @usage       bench_render
+ *
+ * Renders the same bitmaps into memory with ILI9341_RenderBitmap / ILI9341_RenderBitmapColMajor
+ * and with their per-pixel path, ILI9341_RenderScaledBitmap at a scale of 1, prints the time per
+ * pixel of both and fails if their output differs, with each kernel set the CPU supports, and
+ * checks bitmaps scaled to 40000 pixels against the source pixels divided out. Then checks every
+ * kernel set against the portable C kernels (ILI9341_KERNELS_C) for bit-exact output over all
+ * lengths up to 320 pixels at every source alignment, both sides of the length where a C kernel
+ * switches to its table, and prints the time per pixel of each conversion in each set. Last,
+ * times a clock line of text drawn with its glyphs rendered and copied out of a glyph cache.
+ * Nothing is sent, the emulator is not involved: the panel hooks drop every byte.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ili9341.h"
+#include "ili9341_pixel.h"
+
+/** @var Source bitmap, large enough for a full-width 240x240 image */
+static uint8_t bitmap[240 * 240 / 8];
+
+/** @var Pixels rendered by the two paths */
+static uint8_t out_fast[240 * 240 * 2], out_ref[240 * 240 * 2];
+
+/** @var Random source pixels of the conversions, 32-bit aligned, 4 bytes per pixel at most */
+static uint32_t pixels[240 * 240 + 4];
+
+/** @var Conversions, named as in the output */
+static const char *const conversions[] = { "expand_1bpp", "swap_565", "pack_rgb888", "pack_argb8888" };
+
+/** @struct Bitmap size and layout of a case */
+typedef struct {
+  const char *name;
+  uint16_t w, h;
+  bool col_major;
+} render_case_t;
+
+/** @var Cases, 37x29 leaves a partial last byte */
+static const render_case_t cases[] = {
+  { "32x32",          32,  32, false },
+  { "37x29",          37,  29, false },
+  { "240x240",       240, 240, false },
+  { "32x32_col",      32,  32, true },
+  { "240x240_col",   240, 240, true },
+};
+
+/** @var Glyph cache pool of the text case, 16 cells of scale 2 */
+static uint32_t glyph_pool[16 * ILI9341_GLYPH_SLOT_SIZE(2) / 4];
+
+static void _sink_buf (const ili9341_buf_t *buf)
+{
+  (void) buf;
+}
+
+static void _sink_byte (uint8_t byte)
+{
+  (void) byte;
+}
+
+/** @var Hooks of a panel that drops everything, only the driver is timed */
+static const ili9341_hw_intf_t sink = {
+  .sendbuf = _sink_buf,
+  .sendbyte = _sink_byte,
+};
+
+static double _now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @desc    Renders a case once into out
+ *
+ * @param   const render_case_t* c
+ * @param   bool fast the table path, else the per-pixel one
+ * @param   uint8_t* out
+ *
+ * @return  void
+ */
+static void _render (const render_case_t *c, bool fast, uint8_t *out)
+{
+  if (fast && c->col_major) {
+    ILI9341_RenderBitmapColMajor(out, bitmap, c->w, c->h, ILI9341_WHITE, ILI9341_RGB565(4, 8, 12));
+  } else if (fast) {
+    ILI9341_RenderBitmap(out, bitmap, c->w, c->h, ILI9341_WHITE, ILI9341_RGB565(4, 8, 12));
+  } else if (c->col_major) {
+    ILI9341_RenderScaledBitmapColMajor(out, c->w, c->h, bitmap, c->w, c->h, ILI9341_WHITE, ILI9341_RGB565(4, 8, 12));
+  } else {
+    ILI9341_RenderScaledBitmap(out, c->w, c->h, bitmap, c->w, c->h, ILI9341_WHITE, ILI9341_RGB565(4, 8, 12));
+  }
+}
+
+/**
+ * @desc    Renders a case for at least 100 ms
+ *
+ * @param   const render_case_t* c
+ * @param   bool fast
+ * @param   uint8_t* out
+ *
+ * @return  double ns per pixel
+ */
+static double _measure (const render_case_t *c, bool fast, uint8_t *out)
+{
+  double start = _now_ns();
+  double elapsed;
+  unsigned reps = 0;
+
+  do {
+    _render(c, fast, out);
+    reps++;
+  } while ((elapsed = _now_ns() - start) < 100e6);
+  return elapsed / reps / ((double) c->w * c->h);
+}
+
+/**
+ * @desc    Compares the bitmap renderers with a kernel set against their per-pixel path
+ *
+ * @param   ili9341_kernels_t set
+ *
+ * @return  int mismatches
+ */
+static int _check_render (ili9341_kernels_t set)
+{
+  int mismatches = 0;
+
+  ili9341_use_kernels(set);
+  for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    const render_case_t *c = &cases[i];
+
+    _render(c, false, out_ref);
+    _render(c, true, out_fast);
+    if (memcmp(out_ref, out_fast, (size_t) c->w * c->h * 2) != 0) {
+      printf("MISMATCH %s %s\n", ili9341_kernels_name(set), c->name);
+      mismatches++;
+    }
+  }
+  return mismatches;
+}
+
+/**
+ * @desc    Compares bitmaps scaled to a single row and a single column of 40000 pixels, past the 32767
+ *          where the remainders of the stepper would wrap in 16 bits, with the source pixel divided out
+ *
+ * @param   void
+ *
+ * @return  int mismatches
+ */
+static int _check_scaled_wide (void)
+{
+  static const uint16_t src_len[] = { 39999, 25000, 7 };
+  const uint16_t dst_len = 40000;
+  int mismatches = 0;
+
+  for (unsigned i = 0; i < sizeof(src_len) / sizeof(src_len[0]); i++) {
+    for (unsigned col = 0; col < 2; col++) {
+      if (col) {
+        ILI9341_RenderScaledBitmapColMajor(out_fast, 1, dst_len, bitmap, 1, src_len[i], ILI9341_WHITE, ILI9341_BLACK);
+      } else {
+        ILI9341_RenderScaledBitmap(out_fast, dst_len, 1, bitmap, src_len[i], 1, ILI9341_WHITE, ILI9341_BLACK);
+      }
+      for (uint32_t j = 0; j < dst_len; j++) {
+        uint32_t bit = j * src_len[i] / dst_len;
+        if (out_fast[j*2] != (((bitmap[bit >> 3] >> (bit & 7)) & 1) ? 0xff : 0x00)) {
+          printf("MISMATCH scaled %u to %u %s, pixel %u\n", src_len[i], dst_len, col ? "rows" : "columns", (unsigned) j);
+          mismatches++;
+          break;
+        }
+      }
+    }
+  }
+  return mismatches;
+}
+
+/**
+ * @desc    Runs a conversion of count pixels from the source pixels, offset by shift bytes
+ *
+ * @param   unsigned conv index in conversions
+ * @param   uint8_t* out
+ * @param   uint32_t count
+ * @param   unsigned shift
+ *
+ * @return  void
+ */
+static void _convert (unsigned conv, uint8_t *out, uint32_t count, unsigned shift)
+{
+  const uint8_t *src = (const uint8_t *) pixels + shift;
+
+  switch (conv) {
+    case 0:
+      ili9341_expand_1bpp(out, src, count, ILI9341_RGB565(31, 40, 3), ILI9341_RGB565(1, 7, 30));
+      break;
+    case 1:
+      ili9341_swap_565(out, (const uint16_t *) src, count);
+      break;
+    case 2:
+      ili9341_pack_rgb888(out, src, count);
+      break;
+    default:
+      ili9341_pack_argb8888(out, (const uint32_t *) src, count);
+      break;
+  }
+}
+
+/**
+ * @desc    Compares a kernel set with the portable one over all lengths up to a row of 320 pixels,
+ *          at every source alignment the format allows
+ *
+ * @param   ili9341_kernels_t set
+ *
+ * @return  int mismatches
+ */
+static int _check_kernels (ili9341_kernels_t set)
+{
+  // steps of the offset in bytes: any byte for 1 bpp and RGB888, whole pixels for the others
+  static const unsigned shifts[] = { 1, 2, 1, 4 };
+  int mismatches = 0;
+
+  for (unsigned conv = 0; conv < sizeof(conversions) / sizeof(conversions[0]); conv++) {
+    for (unsigned shift = 0; shift < 4 * shifts[conv]; shift += shifts[conv]) {
+      for (uint32_t count = 0; count <= 320; count++) {
+        memset(out_ref, 0x5a, count * 2 + 2);
+        memset(out_fast, 0x5a, count * 2 + 2);
+        ili9341_use_kernels(ILI9341_KERNELS_C);
+        _convert(conv, out_ref, count, shift);
+        ili9341_use_kernels(set);
+        _convert(conv, out_fast, count, shift);
+        // the bytes after the pixels must not be touched either
+        if (memcmp(out_ref, out_fast, count * 2 + 2) != 0) {
+          printf("MISMATCH %s %s, %u pixels at offset %u\n", ili9341_kernels_name(set), conversions[conv],
+                 (unsigned) count, shift);
+          mismatches++;
+          break;
+        }
+      }
+    }
+  }
+  return mismatches;
+}
+
+/**
+ * @desc    Runs a conversion of a full-width 240x240 image for at least 100 ms
+ *
+ * @param   unsigned conv
+ *
+ * @return  double ns per pixel
+ */
+static double _measure_kernel (unsigned conv)
+{
+  double start = _now_ns();
+  double elapsed;
+  unsigned reps = 0;
+
+  do {
+    _convert(conv, out_fast, 240 * 240, 0);
+    reps++;
+  } while ((elapsed = _now_ns() - start) < 100e6);
+  return elapsed / reps / (240.0 * 240);
+}
+
+/**
+ * @desc    Ticks a clock label at scale 2 for at least 100 ms, as status bars redraw numbers
+ *
+ * @param   bool cached with a glyph cache attached
+ *
+ * @return  double ns per character
+ */
+static double _measure_text (bool cached)
+{
+  char text[] = "12:34:50";
+  double start = _now_ns();
+  double elapsed;
+  unsigned reps = 0;
+
+  ILI9341_AttachGlyphCache(cached ? (uint8_t *) glyph_pool : NULL, sizeof(glyph_pool), 2);
+  do {
+    text[7] = '0' + reps % 10;
+    ILI9341_SetPosition(2, 100);
+    ILI9341_DrawStringFast(text, ILI9341_WHITE, 2, ILI9341_BLACK);
+    reps++;
+  } while ((elapsed = _now_ns() - start) < 100e6);
+  ILI9341_AttachGlyphCache(NULL, 0, 0);
+  return elapsed / reps / (sizeof(text) - 1);
+}
+
+/**
+ * @desc    Main function
+ *
+ * @return  int 0 if every path and kernel set renders the same pixels
+ */
+int main(void)
+{
+  int mismatches = 0;
+
+  // deterministic test pattern
+  for (unsigned i = 0; i < sizeof(bitmap); i++) {
+    bitmap[i] = (uint8_t) (i * 37 + (i >> 2));
+  }
+
+  printf("%-14s %12s %12s %8s\n", "case", "per-pixel", "bitmap", "speedup");
+  for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    const render_case_t *c = &cases[i];
+    double ref = _measure(c, false, out_ref);
+    double fast = _measure(c, true, out_fast);
+
+    printf("%-14s %9.3f ns %9.3f ns %7.2fx\n", c->name, ref, fast, ref / fast);
+    if (memcmp(out_ref, out_fast, (size_t) c->w * c->h * 2) != 0) {
+      printf("MISMATCH %s\n", c->name);
+      mismatches++;
+    }
+  }
+
+  mismatches += _check_scaled_wide();
+
+  // pixel conversions in every kernel set
+  srand(1);
+  for (unsigned i = 0; i < sizeof(pixels) / sizeof(pixels[0]); i++) {
+    pixels[i] = (uint32_t) rand() << 16 ^ (uint32_t) rand();
+  }
+  printf("\n%-14s", "kernels");
+  for (unsigned conv = 0; conv < sizeof(conversions) / sizeof(conversions[0]); conv++) {
+    printf(" %14s", conversions[conv]);
+  }
+  printf("\n");
+  for (ili9341_kernels_t set = ILI9341_KERNELS_C; set < ILI9341_KERNELS_COUNT; set++) {
+    if (!ili9341_kernels_supported(set)) {
+      continue;
+    }
+    mismatches += _check_render(set);
+    if (set != ILI9341_KERNELS_C) {
+      mismatches += _check_kernels(set);
+    }
+    ili9341_use_kernels(set);
+    printf("%-14s", ili9341_kernels_name(set));
+    for (unsigned conv = 0; conv < sizeof(conversions) / sizeof(conversions[0]); conv++) {
+      printf(" %11.3f ns", _measure_kernel(conv));
+    }
+    printf("\n");
+  }
+
+  // text through the glyph cache
+  ili9341_set_hw_intf(&sink);
+  double rendered = _measure_text(false);
+  double cached = _measure_text(true);
+  printf("\n%-14s %12s %12s %8s\n", "text", "rendered", "cached", "speedup");
+  printf("%-14s %9.1f ns %9.1f ns %7.2fx\n", "Clock_x2", rendered, cached, rendered / cached);
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        Counting HAL bound at compile time for bench_hal
+ * ---------------------------------------------------------------+
+ *
+ * @file        bench_static_hal.h
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341
+ * ---------------------------------------------------------------+
+ *
+ * Included by lib/ili9341.c when built with -DILI9341_STATIC_HAL='"bench_static_hal.h"'.
+ * Does the same work as the runtime hooks of bench_hal.c, so the difference between the
+ * two builds is the cost of the hook dispatch alone.
+ */
+
+#ifndef __BENCH_STATIC_HAL_H__
+#define __BENCH_STATIC_HAL_H__
+
+#include <stdint.h>
+
+  /** @var Bytes sent and the data register of a pretend SPI peripheral */
+  extern uint32_t bench_hal_bytes;
+  extern volatile uint8_t bench_hal_dr;
+
+  static inline void bench_hal_sendbyte (uint8_t byte)
+  {
+    bench_hal_bytes++;
+    bench_hal_dr = byte;
+  }
+
+  #define ILI9341_HAL_SENDBYTE(lcd, byte) bench_hal_sendbyte(byte)
+
+#endif
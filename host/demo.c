@@ -0,0 +1,69 @@
+/**
+ * --------------------------------------------------------------------------------------------+
+ * @desc        Host example ILI9341 LCD driver running on the panel emulator
+ * --------------------------------------------------------------------------------------------+
+ *
+ * @file        demo.c
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341.h, ili9341_emu.h
+ * --------------------------------------------------------------------------------------------+
+ * @usage       demo [out.ppm]
+ *
+ */
+#include <stdio.h>
+#include "ili9341.h"
+#include "ili9341_emu.h"
+
+/** @var Emulated panel, too large for the stack */
+static ili9341_emu_t emu;
+
+/**
+ * @desc    Main function
+ *
+ * @param   int argc
+ * @param   char** argv
+ *
+ * @return  int
+ */
+int main(int argc, char **argv)
+{
+  const char *path = (argc > 1) ? argv[1] : "ili9341_demo.ppm";
+
+  // bind lcd to the emulator
+  ili9341_emu_init(&emu);
+  ili9341_set_hw_intf(ili9341_emu_intf(&emu));
+
+  // init lcd
+  ILI9341_Init();
+
+  // clear Screen
+  ILI9341_ClearScreen(ILI9341_BLACK);
+
+  // draw horizontal fast line
+  ILI9341_DrawLineHorizontal(10, ILI9341_MAX_X - 10, 12, ILI9341_WHITE);
+  // draw horizontal fast line
+  ILI9341_DrawLineHorizontal(10, ILI9341_MAX_X - 10, 50, ILI9341_WHITE);
+
+  // set position
+  ILI9341_SetPosition(11, 25);
+  // draw string
+  ILI9341_DrawString("ILI9341 LCD DRIVER", ILI9341_RED, X3);
+
+  // filled rectangle, diagonal and scaled text
+  ILI9341_DrawRect(20, 70, 200, 60, ILI9341_RGB565(0, 20, 31));
+  ILI9341_DrawLine(20, 219, 140, 200, ILI9341_WHITE);
+  ILI9341_SetPosition(20, 220);
+  ILI9341_DrawStringFast("Hello emulator", ILI9341_WHITE, 2, ILI9341_BLACK);
+
+  if (ili9341_emu_write_ppm(&emu, path) != ILI9341_SUCCESS) {
+    fprintf(stderr, "cannot write %s\n", path);
+    return 1;
+  }
+  printf("%s: crc32 %08x, %u cmd bytes, %u data bytes, %llu us delay\n",
+         path, (unsigned) ili9341_emu_crc32(&emu),
+         (unsigned) emu.stats.cmd_bytes, (unsigned) emu.stats.data_bytes,
+         (unsigned long long) emu.stats.delay_us);
+
+  return 0;
+}
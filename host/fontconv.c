@@ -0,0 +1,670 @@
+/**
+ * --------------------------------------------------------------------------------------------+
+ * @desc        Converts fonts into the C tables of ili9341_font.h
+ * --------------------------------------------------------------------------------------------+
+ *
+ * @file        fontconv.c
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341_font.h, font.h
+ * --------------------------------------------------------------------------------------------+
+ * @usage       fontconv [-r | -a bpp] [-d factor] [-n name] [-c ranges] [-F fallback] font.bdf > font.c
+ *              fontconv [-r | -a bpp] [-d factor] [-n name] [-c ranges] [-F fallback] -b scale > font.c
+ *
+ * Reads a BDF bitmap font (e.g. converted from TrueType with otf2bdf), or with -b the built-in
+ * 5x8 font scaled by an integer, trims every glyph to the box of its set pixels and writes the
+ * bitmaps, the glyph table, the codepoint ranges and an ili9341_font_t named name. -c selects
+ * the Unicode codepoints to convert as a list of ranges, 0x20-0x7e by default (e.g.
+ * 0x20-0x7e,0xa0-0x17f,0x3040-0x30ff). The fallback glyph drawn for missing codepoints is the
+ * one of -F, else U+FFFD, else '?', else a box. -r run-length encodes the bitmaps.
+ * -d shrinks the font by an integer factor, every pixel taking the coverage of the factor x factor
+ * pixels it stands for: from a font drawn that much larger, -a 2 or -a 4 gives anti-aliased glyphs
+ * of 2 or 4 bits per pixel.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "font.h"
+#include "ili9341_font.h"
+
+/** @struct Glyph being converted, pixel values row after row */
+typedef struct {
+  uint32_t code;            // codepoint, FALLBACK_BOX for a generated fallback glyph
+  int w, h;
+  int x_offset, y_offset;   // as in ili9341_font_glyph_t
+  int advance;
+  uint8_t *px;
+} glyph_t;
+
+// code of the box generated when the font has no fallback glyph
+#define FALLBACK_BOX  0xffffffffUL
+// highest Unicode codepoint
+#define CODE_MAX      0x10ffffUL
+
+/** @var Glyphs read, sorted by codepoint once loaded */
+static glyph_t *glyphs;
+static size_t glyph_count, glyph_cap;
+
+/** @var Codepoint ranges selected by -c */
+static uint32_t select_lo[64], select_hi[64];
+static int select_count;
+
+/** @var Encoded bitmaps of all glyphs */
+static uint8_t *bitmap;
+static size_t bitmap_len, bitmap_cap;
+
+/**
+ * @desc    Appends a byte to the encoded bitmaps
+ *
+ * @param   uint8_t byte
+ *
+ * @return  void
+ */
+static void emit(uint8_t byte)
+{
+  if (bitmap_len == bitmap_cap) {
+    bitmap_cap = bitmap_cap ? bitmap_cap * 2 : 4096;
+    bitmap = realloc(bitmap, bitmap_cap);
+    if (!bitmap) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+  bitmap[bitmap_len++] = byte;
+}
+
+/**
+ * @desc    Adds a glyph
+ *
+ * @param   uint32_t code
+ *
+ * @return  glyph_t*
+ */
+static glyph_t *add_glyph(uint32_t code)
+{
+  if (glyph_count == glyph_cap) {
+    glyph_cap = glyph_cap ? glyph_cap * 2 : 256;
+    glyphs = realloc(glyphs, glyph_cap * sizeof(glyph_t));
+    if (!glyphs) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+  memset(&glyphs[glyph_count], 0, sizeof(glyph_t));
+  glyphs[glyph_count].code = code;
+  return &glyphs[glyph_count++];
+}
+
+/**
+ * @desc    Allocates the pixels of a glyph
+ *
+ * @param   glyph_t* g with w and h set
+ *
+ * @return  void
+ */
+static void alloc_px(glyph_t *g)
+{
+  g->px = calloc(g->w * g->h + 1, 1);
+  if (!g->px) {
+    perror("calloc");
+    exit(1);
+  }
+}
+
+/**
+ * @desc    Orders glyphs by codepoint
+ *
+ * @param   const void* a
+ * @param   const void* b
+ *
+ * @return  int
+ */
+static int cmp_code(const void *a, const void *b)
+{
+  uint32_t ca = ((const glyph_t *) a)->code, cb = ((const glyph_t *) b)->code;
+
+  return (ca > cb) - (ca < cb);
+}
+
+/**
+ * @desc    Finds the glyph of a codepoint among the sorted glyphs
+ *
+ * @param   uint32_t code
+ *
+ * @return  glyph_t* NULL if the font does not have it
+ */
+static glyph_t *find_glyph(uint32_t code)
+{
+  glyph_t key = { .code = code };
+
+  return bsearch(&key, glyphs, glyph_count, sizeof(glyph_t), cmp_code);
+}
+
+/**
+ * @desc    Parses a list of codepoint ranges, e.g. 0x20-0x7e,0xa0-0xff,0x20ac
+ *
+ * @param   const char* list
+ *
+ * @return  int 0, -1 if malformed
+ */
+static int parse_ranges(const char *list)
+{
+  char *end;
+
+  select_count = 0;
+  while (*list) {
+    if (select_count == (int) (sizeof(select_lo) / sizeof(select_lo[0]))) {
+      return -1;
+    }
+    select_lo[select_count] = strtoul(list, &end, 0);
+    select_hi[select_count] = select_lo[select_count];
+    if (end == list) {
+      return -1;
+    }
+    if (*end == '-') {
+      list = end + 1;
+      select_hi[select_count] = strtoul(list, &end, 0);
+      if (end == list) {
+        return -1;
+      }
+    }
+    if (select_lo[select_count] > select_hi[select_count] || select_hi[select_count] > CODE_MAX) {
+      return -1;
+    }
+    select_count++;
+    list = (*end == ',') ? end + 1 : end;
+    if (*end && *end != ',') {
+      return -1;
+    }
+  }
+  return select_count ? 0 : -1;
+}
+
+/**
+ * @desc    Tells if a codepoint was selected by -c
+ *
+ * @param   uint32_t code
+ *
+ * @return  bool
+ */
+static bool selected(uint32_t code)
+{
+  for (int i = 0; i < select_count; i++) {
+    if (code >= select_lo[i] && code <= select_hi[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @desc    Adds a box as the fallback glyph, an outline one column and row of the font thick
+ *
+ * @param   int ascent
+ * @param   int thick
+ *
+ * @return  glyph_t*
+ */
+static glyph_t *add_box(int ascent, int thick)
+{
+  glyph_t *g = add_glyph(FALLBACK_BOX);
+
+  g->h = (ascent * 3 / 4 > 3 * thick) ? ascent * 3 / 4 : 3 * thick;
+  g->w = (g->h * 2 / 3 > 3 * thick) ? g->h * 2 / 3 : 3 * thick;
+  g->x_offset = thick;
+  g->y_offset = -g->h;
+  g->advance = g->w + 2 * thick;
+  alloc_px(g);
+  for (int y = 0; y < g->h; y++) {
+    for (int x = 0; x < g->w; x++) {
+      g->px[y * g->w + x] = (x < thick || x >= g->w - thick || y < thick || y >= g->h - thick);
+    }
+  }
+  return g;
+}
+
+/**
+ * @desc    Reads a BDF font
+ *
+ * @param   FILE* f
+ * @param   int* ascent
+ * @param   int* line_height
+ *
+ * @return  int 0, -1 on a malformed file
+ */
+static int load_bdf(FILE *f, int *ascent, int *line_height)
+{
+  char line[512];
+  long enc = -1;
+  int descent = 0, adv = 0, bw = 0, bh = 0, bx = 0, by = 0, row = -1;
+  glyph_t *g = NULL;
+
+  *ascent = 0;
+  while (fgets(line, sizeof(line), f)) {
+    if (sscanf(line, "FONT_ASCENT %d", ascent) == 1 || sscanf(line, "FONT_DESCENT %d", &descent) == 1) {
+      continue;
+    }
+    if (sscanf(line, "ENCODING %ld", &enc) == 1 || sscanf(line, "DWIDTH %d", &adv) == 1) {
+      continue;
+    }
+    if (sscanf(line, "BBX %d %d %d %d", &bw, &bh, &bx, &by) == 4) {
+      continue;
+    }
+    if (strncmp(line, "BITMAP", 6) == 0) {
+      // glyphs without a Unicode encoding are left out
+      if (enc < 0 || enc > (long) CODE_MAX || bw < 0 || bh < 0 || bw > 255 || bh > 255) {
+        g = NULL;
+        continue;
+      }
+      g = add_glyph(enc);
+      g->w = bw;
+      g->h = bh;
+      g->x_offset = bx;
+      // BDF places the bottom edge of the box above the baseline
+      g->y_offset = -(by + bh);
+      g->advance = adv;
+      alloc_px(g);
+      row = 0;
+      continue;
+    }
+    if (strncmp(line, "ENDCHAR", 7) == 0) {
+      g = NULL;
+      enc = -1;
+      continue;
+    }
+    if (g && row >= 0 && row < g->h) {
+      // a row is hex digits, MSB first, padded to whole bytes
+      for (int x = 0; x < g->w; x++) {
+        char digit[2] = { line[x / 4], 0 };
+        int nibble = (int) strtol(digit, NULL, 16);
+        g->px[row * g->w + x] = (nibble >> (3 - x % 4)) & 1;
+      }
+      row++;
+    }
+  }
+  *line_height = *ascent + descent;
+  return *ascent > 0 ? 0 : -1;
+}
+
+/**
+ * @desc    Takes the built-in 5x8 font scaled by an integer, the baseline is the bottom of the cell
+ *
+ * @param   int scale
+ * @param   int* ascent
+ * @param   int* line_height
+ *
+ * @return  void
+ */
+static void load_builtin(int scale, int *ascent, int *line_height)
+{
+  for (int c = 0x20; c <= 0x7f; c++) {
+    glyph_t *g = add_glyph(c);
+    g->w = CHARS_COLS_LENGTH * scale;
+    g->h = CHARS_ROWS_LENGTH * scale;
+    g->x_offset = 0;
+    g->y_offset = -g->h;
+    // one column of spacing, the trimmed box sets the rest
+    g->advance = 0;
+    alloc_px(g);
+    for (int y = 0; y < g->h; y++) {
+      for (int x = 0; x < g->w; x++) {
+        g->px[y * g->w + x] = (FONTS[c - 0x20][x / scale] >> (y / scale)) & 1;
+      }
+    }
+  }
+  *ascent = CHARS_ROWS_LENGTH * scale;
+  *line_height = CHARS_ROWS_LENGTH * scale;
+}
+
+/**
+ * @desc    Divides rounding towards minus infinity
+ *
+ * @param   int a
+ * @param   int d > 0
+ *
+ * @return  int
+ */
+static int floor_div(int a, int d)
+{
+  return (a >= 0) ? a / d : -((-a + d - 1) / d);
+}
+
+/**
+ * @desc    Shrinks a glyph by an integer factor on the grid of its origin, a pixel gets the coverage
+ *          of the pixels it stands for in levels from 0 to 2^bpp - 1
+ *
+ * @param   glyph_t* g
+ * @param   int d factor
+ * @param   int bpp
+ *
+ * @return  void
+ */
+static void downsample(glyph_t *g, int d, int bpp)
+{
+  int max = (1 << bpp) - 1;
+  int x0 = floor_div(g->x_offset, d), y0 = floor_div(g->y_offset, d);
+  int w = floor_div(g->x_offset + g->w - 1, d) - x0 + 1;
+  int h = floor_div(g->y_offset + g->h - 1, d) - y0 + 1;
+  uint8_t *px = calloc(w * h + 1, 1);
+
+  if (!px) {
+    perror("calloc");
+    exit(1);
+  }
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      int set = 0;
+      for (int sy = (y0 + y) * d; sy < (y0 + y + 1) * d; sy++) {
+        for (int sx = (x0 + x) * d; sx < (x0 + x + 1) * d; sx++) {
+          int gx = sx - g->x_offset, gy = sy - g->y_offset;
+          set += (gx >= 0 && gx < g->w && gy >= 0 && gy < g->h && g->px[gy * g->w + gx]);
+        }
+      }
+      // rounded to the nearest level
+      px[y * w + x] = (set * max * 2 + d * d) / (d * d * 2);
+    }
+  }
+  free(g->px);
+  g->px = px;
+  g->w = w;
+  g->h = h;
+  g->x_offset = x0;
+  g->y_offset = y0;
+  g->advance = (g->advance + d / 2) / d;
+}
+
+/**
+ * @desc    Shrinks a glyph to the box of its set pixels
+ *
+ * @param   glyph_t* g
+ *
+ * @return  void
+ */
+static void trim(glyph_t *g)
+{
+  int x0 = g->w, y0 = g->h, x1 = -1, y1 = -1;
+
+  for (int y = 0; y < g->h; y++) {
+    for (int x = 0; x < g->w; x++) {
+      if (g->px[y * g->w + x]) {
+        x0 = (x < x0) ? x : x0;
+        x1 = (x > x1) ? x : x1;
+        y0 = (y < y0) ? y : y0;
+        y1 = (y > y1) ? y : y1;
+      }
+    }
+  }
+  if (x1 < 0) {
+    g->w = g->h = 0;
+    return;
+  }
+  for (int y = y0; y <= y1; y++) {
+    memmove(&g->px[(y - y0) * (x1 - x0 + 1)], &g->px[y * g->w + x0], x1 - x0 + 1);
+  }
+  g->x_offset += x0;
+  g->y_offset += y0;
+  g->w = x1 - x0 + 1;
+  g->h = y1 - y0 + 1;
+}
+
+/**
+ * @desc    Encodes the pixels of a glyph, packed MSB first or as runs of 4 bits
+ *
+ * @param   const glyph_t* g
+ * @param   bool rle
+ * @param   int bpp of packed pixels
+ *
+ * @return  void
+ */
+static void encode(const glyph_t *g, bool rle, int bpp)
+{
+  int n = g->w * g->h;
+
+  if (rle) {
+    // runs alternate between clear and set pixels, starting with clear ones
+    int nibbles = 0, nibble = 0;
+    bool set = false;
+    for (int i = 0; i < n; set = !set) {
+      int run = 0;
+      // a longer run carries on after an empty run of the other value
+      while (i + run < n && (g->px[i + run] != 0) == set && run < 15) {
+        run++;
+      }
+      nibble = (nibble << 4) | run;
+      if (++nibbles % 2 == 0) {
+        emit(nibble);
+        nibble = 0;
+      }
+      i += run;
+    }
+    if (nibbles % 2) {
+      emit(nibble << 4);
+    }
+    return;
+  }
+  for (int i = 0; i < n; i += 8 / bpp) {
+    uint8_t byte = 0;
+    for (int b = 0; b < 8 / bpp; b++) {
+      byte |= (i + b < n) ? g->px[i + b] << (8 - bpp * (b + 1)) : 0;
+    }
+    emit(byte);
+  }
+}
+
+/**
+ * @desc    Converts a glyph: shrinks, trims and encodes it
+ *
+ * @param   glyph_t* g
+ * @param   int scale of the built-in font, 0 for BDF fonts
+ * @param   int factor
+ * @param   bool rle
+ * @param   int bpp
+ *
+ * @return  int 0, -1 if it does not fit ili9341_font_glyph_t
+ */
+static int convert(glyph_t *g, int scale, int factor, bool rle, int bpp)
+{
+  if (factor > 1 || bpp > 1) {
+    downsample(g, factor, bpp);
+  }
+  trim(g);
+  if (scale > 0 && g->code != FALLBACK_BOX) {
+    // built-in glyphs advance by their box and a scaled spacing column, blank ones by half a cell
+    int spacing = (scale + factor / 2) / factor;
+    g->advance = g->w ? g->w + (spacing ? spacing : 1) : 3 * scale / factor;
+    g->x_offset = 0;
+  }
+  if (g->advance > 255 || g->x_offset < -128 || g->x_offset > 127 || g->y_offset < -128 || g->y_offset > 127) {
+    return -1;
+  }
+  encode(g, rle, bpp);
+  return 0;
+}
+
+/**
+ * @desc    Writes the comment naming a glyph
+ *
+ * @param   const glyph_t* g
+ *
+ * @return  void
+ */
+static void print_name(const glyph_t *g)
+{
+  if (g->code == FALLBACK_BOX) {
+    printf("   // fallback box\n");
+  } else if (g->code >= 0x20 && g->code < 0x7f && g->code != '\\') {
+    printf("   // U+%04X '%c'\n", g->code, (char) g->code);
+  } else {
+    printf("   // U+%04X\n", g->code);
+  }
+}
+
+/**
+ * @desc    Main function
+ *
+ * @param   int argc
+ * @param   char** argv
+ *
+ * @return  int
+ */
+int main(int argc, char **argv)
+{
+  const char *name = "font", *path = NULL;
+  int scale = 0, bpp = 1, factor = 1, ascent, line_height;
+  long fallback_code = -1;
+  bool rle = false, ok = true;
+  glyph_t *fallback;
+  size_t *out, out_count = 0, selected_count, kept = 0, fallback_index = SIZE_MAX, range_count = 0;
+  uint32_t *offsets;
+
+  parse_ranges("0x20-0x7e");
+  for (int i = 1; i < argc && ok; i++) {
+    if (strcmp(argv[i], "-r") == 0) {
+      rle = true;
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      name = argv[++i];
+    } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      ok = parse_ranges(argv[++i]) == 0;
+    } else if (strcmp(argv[i], "-F") == 0 && i + 1 < argc) {
+      fallback_code = strtol(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+      bpp = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+      factor = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      scale = atoi(argv[++i]);
+    } else if (argv[i][0] != '-' && !path) {
+      path = argv[i];
+    } else {
+      ok = false;
+    }
+  }
+  if (!ok || (!path && scale <= 0) || factor < 1 || fallback_code > (long) CODE_MAX ||
+      (bpp != 1 && bpp != 2 && bpp != 4) || (rle && bpp != 1)) {
+    fprintf(stderr, "usage: %s [-r | -a bpp] [-d factor] [-n name] [-c ranges] [-F fallback] font.bdf | -b scale\n", argv[0]);
+    return 1;
+  }
+
+  if (scale > 0) {
+    load_builtin(scale, &ascent, &line_height);
+  } else {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+      perror(path);
+      return 1;
+    }
+    if (load_bdf(f, &ascent, &line_height) != 0) {
+      fprintf(stderr, "%s: not a BDF font\n", path);
+      return 1;
+    }
+    fclose(f);
+  }
+  qsort(glyphs, glyph_count, sizeof(glyph_t), cmp_code);
+  // one glyph for a codepoint defined twice
+  for (size_t i = 0; i < glyph_count; i++) {
+    if (kept && glyphs[kept - 1].code == glyphs[i].code) {
+      free(glyphs[i].px);
+    } else {
+      glyphs[kept++] = glyphs[i];
+    }
+  }
+  glyph_count = kept;
+
+  // fallback glyph, generated if the font has none
+  if (fallback_code >= 0) {
+    fallback = find_glyph(fallback_code);
+    if (!fallback) {
+      fprintf(stderr, "no glyph U+%04lX for the fallback\n", fallback_code);
+      return 1;
+    }
+  } else {
+    fallback = find_glyph(0xfffd);
+    fallback = fallback ? fallback : find_glyph('?');
+  }
+  if (!fallback) {
+    fallback = add_box(ascent, factor);
+  }
+
+  // selected glyphs in codepoint order, the fallback glyph after them unless it is one of them
+  out = malloc((glyph_count + 1) * sizeof(size_t));
+  offsets = malloc((glyph_count + 1) * sizeof(uint32_t));
+  if (!out || !offsets) {
+    perror("malloc");
+    return 1;
+  }
+  for (size_t i = 0; i < glyph_count; i++) {
+    if (selected(glyphs[i].code)) {
+      if (&glyphs[i] == fallback) {
+        fallback_index = out_count;
+      }
+      out[out_count++] = i;
+    }
+  }
+  selected_count = out_count;
+  if (fallback_index == SIZE_MAX) {
+    fallback_index = out_count;
+    out[out_count++] = fallback - glyphs;
+  }
+  if (out_count > 0xffff) {
+    fprintf(stderr, "more than 65535 glyphs\n");
+    return 1;
+  }
+
+  ascent = (ascent + factor - 1) / factor;
+  line_height = (line_height + factor - 1) / factor;
+  if (ascent > 255 || line_height > 255) {
+    fprintf(stderr, "font taller than 255 rows\n");
+    return 1;
+  }
+
+  for (size_t i = 0; i < out_count; i++) {
+    glyph_t *g = &glyphs[out[i]];
+    offsets[i] = bitmap_len;
+    if (convert(g, scale, factor, rle, bpp) != 0) {
+      fprintf(stderr, "glyph U+%04X does not fit ili9341_font_glyph_t\n", g->code);
+      return 1;
+    }
+  }
+
+  printf("// Generated by fontconv from %s", path ? path : "the built-in 5x8 font");
+  if (scale > 0) {
+    printf(" scaled %dx", scale);
+  }
+  if (factor > 1) {
+    printf(" shrunk 1/%d", factor);
+  }
+  if (bpp > 1) {
+    printf(", %d bpp", bpp);
+  }
+  printf("%s, %zu glyphs, %zu bitmap bytes\n", rle ? ", run-length encoded" : "", out_count, bitmap_len);
+  printf("#include \"ili9341_font.h\"\n\n");
+  printf("static const uint8_t %s_bitmap[] = {", name);
+  for (size_t i = 0; i < bitmap_len; i++) {
+    printf("%s0x%02x,", (i % 16) ? " " : "\n  ", bitmap[i]);
+  }
+  printf("%s\n};\n\n", bitmap_len ? "" : "\n  0x00");
+  printf("static const ili9341_font_glyph_t %s_glyphs[] = {\n", name);
+  for (size_t i = 0; i < out_count; i++) {
+    const glyph_t *g = &glyphs[out[i]];
+    printf("  { %6u, %3d, %3d, %3d, %4d, %4d },", offsets[i], g->w, g->h, g->advance, g->x_offset, g->y_offset);
+    print_name(g);
+  }
+  printf("};\n\n");
+  // runs of consecutive codepoints of the selected glyphs
+  printf("static const ili9341_font_range_t %s_ranges[] = {\n", name);
+  for (size_t i = 0, n; i < selected_count; i += n) {
+    uint32_t first = glyphs[out[i]].code;
+    for (n = 1; i + n < selected_count && n < 0xffff && glyphs[out[i + n]].code == first + n; n++) {
+    }
+    printf("  { 0x%06x, %5zu, %5zu },\n", first, n, i);
+    range_count++;
+  }
+  printf("%s};\n\n", range_count ? "" : "  { 0, 0, 0 }\n");
+  printf("const ili9341_font_t %s = {\n", name);
+  printf("  %s_bitmap, %s_glyphs, %s_ranges, %zu, %zu, %d, %d, %s\n", name, name, name, range_count, fallback_index, line_height, ascent,
+    rle ? "ILI9341_FONT_RLE" : (bpp == 4) ? "ILI9341_FONT_4BPP" : (bpp == 2) ? "ILI9341_FONT_2BPP" : "0");
+  printf("};\n");
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        Worker thread draining an ILI9341 command queue
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_drain.c
+ * @tested      Linux x86-64 (gcc, pthreads)
+ *
+ * @depend      ili9341_queue
+ * ---------------------------------------------------------------+
+ */
+
+#include <time.h>
+#include "ili9341_drain.h"
+
+/**
+ * @desc    Worker loop: drain, then sleep until kicked or 1 ms passed
+ *
+ * @param   void* arg ili9341_drain_t
+ *
+ * @return  void*
+ */
+static void *_drain_worker (void *arg)
+{
+  ili9341_drain_t *d = arg;
+  bool stop = false;
+
+  while (!stop) {
+    ili9341_queue_drain(d->q, 0);
+
+    pthread_mutex_lock(&d->lock);
+    if (!d->kicked && !d->stop) {
+      struct timespec until;
+      clock_gettime(CLOCK_REALTIME, &until);
+      until.tv_nsec += 1000000;
+      if (until.tv_nsec >= 1000000000) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000;
+      }
+      pthread_cond_timedwait(&d->wake, &d->lock, &until);
+    }
+    d->kicked = false;
+    stop = d->stop;
+    pthread_mutex_unlock(&d->lock);
+  }
+  // commands queued before the stop request still run
+  ili9341_queue_drain(d->q, 0);
+
+  return NULL;
+}
+
+char ili9341_drain_start (ili9341_drain_t *d, ili9341_queue_t *q)
+{
+  d->q = q;
+  d->stop = false;
+  d->kicked = false;
+  pthread_mutex_init(&d->lock, NULL);
+  pthread_cond_init(&d->wake, NULL);
+  if (pthread_create(&d->thread, NULL, _drain_worker, d) != 0) {
+    pthread_cond_destroy(&d->wake);
+    pthread_mutex_destroy(&d->lock);
+    return ILI9341_ERROR;
+  }
+  return ILI9341_SUCCESS;
+}
+
+void ili9341_drain_kick (ili9341_drain_t *d)
+{
+  pthread_mutex_lock(&d->lock);
+  d->kicked = true;
+  pthread_cond_signal(&d->wake);
+  pthread_mutex_unlock(&d->lock);
+}
+
+void ili9341_drain_stop (ili9341_drain_t *d)
+{
+  pthread_mutex_lock(&d->lock);
+  d->stop = true;
+  pthread_cond_signal(&d->wake);
+  pthread_mutex_unlock(&d->lock);
+  pthread_join(d->thread, NULL);
+  pthread_cond_destroy(&d->wake);
+  pthread_mutex_destroy(&d->lock);
+}
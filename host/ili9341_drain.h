@@ -0,0 +1,63 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        Worker thread draining an ILI9341 command queue
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_drain.h
+ * @tested      Linux x86-64 (gcc, pthreads)
+ *
+ * @depend      ili9341_queue
+ * ---------------------------------------------------------------+
+ *
+ * Host stand-in for the transport task or DMA-complete interrupt of a
+ * target: a thread that executes queued commands as they arrive. The
+ * producer stays lock-free, the mutex only guards the sleep of the idle
+ * worker, which ili9341_drain_kick() cuts short.
+ */
+
+#ifndef __ILI9341_DRAIN_H__
+#define __ILI9341_DRAIN_H__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include "ili9341_queue.h"
+
+  /** @struct Drain worker */
+  typedef struct {
+    ili9341_queue_t *q;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool stop;
+    bool kicked;
+  } ili9341_drain_t;
+
+  /**
+   * @desc    Starts a worker executing the commands of a queue
+   *
+   * @param   ili9341_drain_t* d
+   * @param   ili9341_queue_t* q
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if the thread cannot be created
+   */
+  char ili9341_drain_start (ili9341_drain_t *d, ili9341_queue_t *q);
+
+  /**
+   * @desc    Wakes the worker after commands were queued, optional: an idle worker polls every millisecond
+   *
+   * @param   ili9341_drain_t* d
+   *
+   * @return  void
+   */
+  void ili9341_drain_kick (ili9341_drain_t *d);
+
+  /**
+   * @desc    Executes the commands still queued and joins the worker
+   *
+   * @param   ili9341_drain_t* d
+   *
+   * @return  void
+   */
+  void ili9341_drain_stop (ili9341_drain_t *d);
+
+#endif
@@ -0,0 +1,518 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        ILI9341 host-side panel emulator
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_emu.c
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341
+ * ---------------------------------------------------------------+
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ili9341_emu.h"
+
+static void _emu_clock_byte (ili9341_emu_t *emu, uint8_t byte);
+
+/** @var Emulators bound to the hw interface slots */
+static ili9341_emu_t *_emu_slots[ILI9341_EMU_MAX_INSTANCES];
+
+/* The hook signatures carry no context, so every slot gets its own set of trampolines */
+#define _EMU_SLOT(n)                                                                              \
+  static void _emu##n##_reset_pin(ili9341_reset_e v) { ili9341_emu_reset_pin(_emu_slots[n], v); } \
+  static void _emu##n##_dc_pin(ili9341_dc_e v) { ili9341_emu_dc_pin(_emu_slots[n], v); }          \
+  static void _emu##n##_cs_pin(ili9341_cs_e v) { ili9341_emu_cs_pin(_emu_slots[n], v); }          \
+  static void _emu##n##_delay(uint32_t us) { ili9341_emu_delay(_emu_slots[n], us); }              \
+  static void _emu##n##_sendbuf(const ili9341_buf_t *b) { ili9341_emu_sendbuf(_emu_slots[n], b); }\
+  static void _emu##n##_sendbyte(uint8_t b) { ili9341_emu_sendbyte(_emu_slots[n], b); }           \
+  static void _emu##n##_commit(void *_unused) { (void) _unused; ili9341_emu_commit(_emu_slots[n]); } \
+  static void _emu##n##_barrier(void *_unused) { (void) _unused; ili9341_emu_barrier(_emu_slots[n]); }
+
+#define _EMU_INTF(n) {                \
+    .reset_pin = _emu##n##_reset_pin, \
+    .dc_pin = _emu##n##_dc_pin,       \
+    .cs_pin = _emu##n##_cs_pin,       \
+    .delay = _emu##n##_delay,         \
+    .sendbuf = _emu##n##_sendbuf,     \
+    .sendbyte = _emu##n##_sendbyte,   \
+    .commit = _emu##n##_commit,       \
+    .barrier = _emu##n##_barrier      \
+  }
+
+_EMU_SLOT(0)
+_EMU_SLOT(1)
+_EMU_SLOT(2)
+_EMU_SLOT(3)
+
+static const ili9341_hw_intf_t _emu_intf[ILI9341_EMU_MAX_INSTANCES] = {
+  _EMU_INTF(0), _EMU_INTF(1), _EMU_INTF(2), _EMU_INTF(3)
+};
+
+#undef _EMU_SLOT
+#undef _EMU_INTF
+
+/**
+ * @desc    Loads the register values the controller has after a hardware or software reset
+ *
+ * @param   ili9341_emu_t*
+ *
+ * @return  void
+ */
+static void _emu_registers_default (ili9341_emu_t *emu)
+{
+  emu->cmd = ILI9341_NOP;
+  emu->nparams = 0;
+  emu->px_fill = 0;
+  emu->x = 0;
+  emu->y = 0;
+  emu->sc = 0;
+  emu->ec = ILI9341_MAX_X - 1;
+  emu->sp = 0;
+  emu->ep = ILI9341_MAX_Y - 1;
+  emu->madctl = 0x00;
+  emu->colmod = 0x66;
+  emu->tfa = 0;
+  emu->vsa = ILI9341_MAX_Y;
+  emu->bfa = 0;
+  emu->vsp = 0;
+  emu->inverted = false;
+  emu->sleeping = true;
+  emu->display_on = false;
+}
+
+char ili9341_emu_init (ili9341_emu_t *emu)
+{
+  int8_t slot = -1;
+
+  // reuse the slot of a re-initialized emulator, take the first free one otherwise
+  for (int8_t i = 0; i < ILI9341_EMU_MAX_INSTANCES; i++) {
+    if (_emu_slots[i] == emu) {
+      slot = i;
+      break;
+    }
+    if (slot < 0 && _emu_slots[i] == NULL) {
+      slot = i;
+    }
+  }
+  if (slot < 0) {
+    return ILI9341_ERROR;
+  }
+
+  memset(emu, 0, sizeof(*emu));
+  _emu_registers_default(emu);
+  emu->dc = DC_HIGH_DATA;
+  emu->cs = CS_HIGH_OFF;
+  emu->reset = RESET_HIGH_NOTSET;
+  emu->slot = slot;
+  emu->intf = _emu_intf[slot];
+  _emu_slots[slot] = emu;
+
+  return ILI9341_SUCCESS;
+}
+
+void ili9341_emu_release (ili9341_emu_t *emu)
+{
+  if (emu->slot >= 0 && _emu_slots[emu->slot] == emu) {
+    _emu_slots[emu->slot] = NULL;
+  }
+  emu->slot = -1;
+}
+
+const ili9341_hw_intf_t *ili9341_emu_intf (ili9341_emu_t *emu)
+{
+  return &emu->intf;
+}
+
+void ili9341_emu_reset_stats (ili9341_emu_t *emu)
+{
+  memset(&emu->stats, 0, sizeof(emu->stats));
+}
+
+void ili9341_emu_fill (ili9341_emu_t *emu, uint16_t color565)
+{
+  for (uint16_t y = 0; y < ILI9341_MAX_Y; y++) {
+    for (uint16_t x = 0; x < ILI9341_MAX_X; x++) {
+      emu->gram[y][x] = color565;
+    }
+  }
+}
+
+uint16_t ili9341_emu_pixel (const ili9341_emu_t *emu, uint16_t x, uint16_t y)
+{
+  if ((x >= ILI9341_MAX_X) || (y >= ILI9341_MAX_Y)) {
+    return 0;
+  }
+  return emu->gram[y][x];
+}
+
+uint16_t ili9341_emu_scanout (const ili9341_emu_t *emu, uint16_t x, uint16_t line)
+{
+  uint16_t page = line;
+  uint16_t color;
+
+  // lines of the scrolling area start at VSP and wrap inside of the area
+  if ((line >= emu->tfa) && (line < emu->tfa + emu->vsa) &&
+      (emu->vsp >= emu->tfa) && (emu->vsp < emu->tfa + emu->vsa)) {
+    page = emu->vsp + (line - emu->tfa);
+    if (page >= emu->tfa + emu->vsa) {
+      page -= emu->vsa;
+    }
+  }
+  color = ili9341_emu_pixel(emu, x, page);
+
+  return emu->inverted ? (uint16_t) ~color : color;
+}
+
+uint32_t ili9341_emu_crc32 (const ili9341_emu_t *emu)
+{
+  uint32_t crc = 0xFFFFFFFF;
+
+  for (uint16_t y = 0; y < ILI9341_MAX_Y; y++) {
+    for (uint16_t x = 0; x < ILI9341_MAX_X; x++) {
+      // big-endian, the byte order the pixel travels on the wire
+      uint8_t bytes[2] = { emu->gram[y][x] >> 8, emu->gram[y][x] & 0xFF };
+      for (uint8_t b = 0; b < 2; b++) {
+        crc ^= bytes[b];
+        for (uint8_t k = 0; k < 8; k++) {
+          crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+      }
+    }
+  }
+  return ~crc;
+}
+
+char ili9341_emu_write_ppm (const ili9341_emu_t *emu, const char *path)
+{
+  FILE *fp = fopen(path, "wb");
+
+  if (fp == NULL) {
+    return ILI9341_ERROR;
+  }
+  fprintf(fp, "P6\n%d %d\n255\n", ILI9341_MAX_X, (int) ILI9341_MAX_Y);
+  for (uint16_t line = 0; line < ILI9341_MAX_Y; line++) {
+    for (uint16_t x = 0; x < ILI9341_MAX_X; x++) {
+      uint16_t color = ili9341_emu_scanout(emu, x, line);
+      uint8_t rgb[3] = {
+        (RGBR(color) << 3) | (RGBR(color) >> 2),
+        (RGBG(color) << 2) | (RGBG(color) >> 4),
+        (RGBB(color) << 3) | (RGBB(color) >> 2)
+      };
+      fwrite(rgb, 1, sizeof(rgb), fp);
+    }
+  }
+  return fclose(fp) == 0 ? ILI9341_SUCCESS : ILI9341_ERROR;
+}
+
+/**
+ * @desc    Stores one pixel at the current address and advances it inside of the window
+ *
+ * @param   ili9341_emu_t*
+ * @param   uint16_t color565
+ *
+ * @return  void
+ */
+static void _emu_store_pixel (ili9341_emu_t *emu, uint16_t color565)
+{
+  if ((emu->x < ILI9341_MAX_X) && (emu->y < ILI9341_MAX_Y)) {
+    emu->gram[emu->y][emu->x] = color565;
+    emu->stats.pixels++;
+  } else {
+    emu->stats.clipped_pixels++;
+  }
+  // column first, then page, wrapping back to the window start
+  if (emu->x >= emu->ec) {
+    emu->x = emu->sc;
+    emu->y = (emu->y >= emu->ep) ? emu->sp : emu->y + 1;
+  } else {
+    emu->x++;
+  }
+}
+
+/**
+ * @desc    Collects a memory write byte into a pixel according to COLMOD
+ *
+ * @param   ili9341_emu_t*
+ * @param   uint8_t
+ *
+ * @return  void
+ */
+static void _emu_memory_byte (ili9341_emu_t *emu, uint8_t byte)
+{
+  uint8_t *px = emu->px_bytes;
+
+  px[emu->px_fill++] = byte;
+  // DBI[2:0] = 110 -> 18 bits/pixel, three bytes with 6 valid msb each
+  if ((emu->colmod & 0x07) == 0x06) {
+    if (emu->px_fill == 3) {
+      _emu_store_pixel(emu, ILI9341_RGB565(px[0] >> 3, px[1] >> 2, px[2] >> 3));
+      emu->px_fill = 0;
+    }
+  // 16 bits/pixel, high byte first
+  } else if (emu->px_fill == 2) {
+    _emu_store_pixel(emu, ((uint16_t) px[0] << 8) | px[1]);
+    emu->px_fill = 0;
+  }
+}
+
+#define _PARAM16(i) (((uint16_t) emu->params[i] << 8) | emu->params[(i) + 1])
+
+/**
+ * @desc    Handles a parameter byte of the current command
+ *
+ * @param   ili9341_emu_t*
+ * @param   uint8_t
+ *
+ * @return  void
+ */
+static void _emu_data_byte (ili9341_emu_t *emu, uint8_t byte)
+{
+  if ((emu->cmd == ILI9341_RAMWR) || (emu->cmd == ILI9341_WMCON)) {
+    _emu_memory_byte(emu, byte);
+    return;
+  }
+  if (emu->nparams < ILI9341_EMU_MAX_PARAMS) {
+    emu->params[emu->nparams] = byte;
+  }
+  emu->nparams++;
+
+  switch (emu->cmd) {
+    case ILI9341_CASET:
+      if (emu->nparams == 4) {
+        emu->sc = _PARAM16(0);
+        emu->ec = _PARAM16(2);
+      }
+      break;
+    case ILI9341_PASET:
+      if (emu->nparams == 4) {
+        emu->sp = _PARAM16(0);
+        emu->ep = _PARAM16(2);
+      }
+      break;
+    case ILI9341_MADCTL:
+      if (emu->nparams == 1) {
+        emu->madctl = byte;
+      }
+      break;
+    case ILI9341_COLMOD:
+      if (emu->nparams == 1) {
+        emu->colmod = byte;
+      }
+      break;
+    case ILI9341_VSCRDEF:
+      if (emu->nparams == 6) {
+        emu->tfa = _PARAM16(0);
+        emu->vsa = _PARAM16(2);
+        emu->bfa = _PARAM16(4);
+      }
+      break;
+    case ILI9341_VSSAD:
+      if (emu->nparams == 2) {
+        emu->vsp = _PARAM16(0);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+#undef _PARAM16
+
+/**
+ * @desc    Handles a command byte
+ *
+ * @param   ili9341_emu_t*
+ * @param   uint8_t
+ *
+ * @return  void
+ */
+static void _emu_command_byte (ili9341_emu_t *emu, uint8_t cmd)
+{
+  emu->cmd = cmd;
+  emu->nparams = 0;
+  emu->px_fill = 0;
+  emu->stats.cmd_count[cmd]++;
+
+  switch (cmd) {
+    case ILI9341_SWRESET:
+      _emu_registers_default(emu);
+      break;
+    case ILI9341_SLPIN:
+      emu->sleeping = true;
+      break;
+    case ILI9341_SLPOUT:
+      emu->sleeping = false;
+      break;
+    case ILI9341_DINVOFF:
+      emu->inverted = false;
+      break;
+    case ILI9341_DINVON:
+      emu->inverted = true;
+      break;
+    case ILI9341_DISPOFF:
+      emu->display_on = false;
+      break;
+    case ILI9341_DISPON:
+      emu->display_on = true;
+      break;
+    case ILI9341_RAMWR:
+      // memory write restarts at the window origin
+      emu->x = emu->sc;
+      emu->y = emu->sp;
+      break;
+    default:
+      break;
+  }
+}
+
+void ili9341_emu_set_deferred (ili9341_emu_t *emu, bool deferred)
+{
+  ili9341_emu_complete(emu);
+  emu->deferred = deferred;
+}
+
+void ili9341_emu_complete (ili9341_emu_t *emu)
+{
+  for (uint8_t i = 0; i < emu->npending; i++) {
+    for (uint16_t j = 0; j < emu->pending[i].len; j++) {
+      _emu_clock_byte(emu, emu->pending[i].buf[j]);
+    }
+  }
+  emu->npending = 0;
+}
+
+/**
+ * @desc    A control line changes, which must not happen while a transfer is in flight
+ *
+ * @param   ili9341_emu_t*
+ *
+ * @return  void
+ */
+static void _emu_line_change (ili9341_emu_t *emu)
+{
+  if (emu->npending) {
+    emu->stats.barrier_violations++;
+  }
+}
+
+void ili9341_emu_reset_pin (ili9341_emu_t *emu, ili9341_reset_e level)
+{
+  emu->stats.reset_calls++;
+  _emu_line_change(emu);
+  // rising edge of RESX ends the reset
+  if ((emu->reset == RESET_LOW_SET) && (level == RESET_HIGH_NOTSET)) {
+    _emu_registers_default(emu);
+  }
+  emu->reset = level;
+  // transfers in flight go out with the new level
+  ili9341_emu_complete(emu);
+}
+
+void ili9341_emu_dc_pin (ili9341_emu_t *emu, ili9341_dc_e level)
+{
+  emu->stats.dc_calls++;
+  if (emu->dc == level) {
+    return;
+  }
+  emu->stats.dc_toggles++;
+  _emu_line_change(emu);
+  emu->dc = level;
+  // transfers in flight go out with the new level
+  ili9341_emu_complete(emu);
+}
+
+void ili9341_emu_cs_pin (ili9341_emu_t *emu, ili9341_cs_e level)
+{
+  emu->stats.cs_calls++;
+  if (emu->cs == level) {
+    return;
+  }
+  emu->stats.cs_toggles++;
+  _emu_line_change(emu);
+  emu->cs = level;
+  // transfers in flight go out with the new level
+  ili9341_emu_complete(emu);
+}
+
+void ili9341_emu_delay (ili9341_emu_t *emu, uint32_t us)
+{
+  emu->stats.delay_calls++;
+  emu->stats.delay_us += us;
+}
+
+/**
+ * @desc    Clocks a byte into the controller
+ *
+ * @param   ili9341_emu_t*
+ * @param   uint8_t
+ *
+ * @return  void
+ */
+static void _emu_clock_byte (ili9341_emu_t *emu, uint8_t byte)
+{
+  if ((emu->cs != CS_LOW_ON) || (emu->reset != RESET_HIGH_NOTSET)) {
+    emu->stats.dropped_bytes++;
+    return;
+  }
+  if (emu->dc == DC_LOW_CMD) {
+    emu->stats.cmd_bytes++;
+    _emu_command_byte(emu, byte);
+  } else {
+    emu->stats.data_bytes++;
+    _emu_data_byte(emu, byte);
+  }
+}
+
+/**
+ * @desc    Clocks in the oldest transfer in flight, the others move up
+ *
+ * @param   ili9341_emu_t*
+ *
+ * @return  void
+ */
+static void _emu_complete_oldest (ili9341_emu_t *emu)
+{
+  for (uint16_t j = 0; j < emu->pending[0].len; j++) {
+    _emu_clock_byte(emu, emu->pending[0].buf[j]);
+  }
+  emu->npending--;
+  memmove(&emu->pending[0], &emu->pending[1], emu->npending * sizeof(emu->pending[0]));
+}
+
+void ili9341_emu_sendbuf (ili9341_emu_t *emu, const ili9341_buf_t *buf)
+{
+  emu->stats.sendbuf_calls++;
+  emu->stats.sendbuf_bytes += buf->len;
+  if (emu->deferred) {
+    // queue is full, the oldest transfer finishes
+    if (emu->npending == ILI9341_EMU_MAX_PENDING) {
+      _emu_complete_oldest(emu);
+    }
+    emu->pending[emu->npending++] = *buf;
+    return;
+  }
+  for (uint16_t i = 0; i < buf->len; i++) {
+    _emu_clock_byte(emu, buf->buf[i]);
+  }
+}
+
+void ili9341_emu_sendbyte (ili9341_emu_t *emu, uint8_t byte)
+{
+  emu->stats.sendbyte_calls++;
+  // bytes queue up behind the transfers in flight
+  ili9341_emu_complete(emu);
+  _emu_clock_byte(emu, byte);
+}
+
+void ili9341_emu_commit (ili9341_emu_t *emu)
+{
+  emu->stats.commit_calls++;
+}
+
+void ili9341_emu_barrier (ili9341_emu_t *emu)
+{
+  emu->stats.barrier_calls++;
+  ili9341_emu_complete(emu);
+}
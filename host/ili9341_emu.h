@@ -0,0 +1,222 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        ILI9341 host-side panel emulator
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_emu.h
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341
+ * ---------------------------------------------------------------+
+ *
+ * Implements ili9341_hw_intf_t on a Linux host. The byte stream produced by
+ * the driver is decoded the same way the controller does (D/C and CS levels,
+ * CASET/PASET/RAMWR/WMCON/MADCTL/COLMOD/VSCRDEF/VSSAD/...) into an in-memory
+ * 240x320 GRAM, and every hook invocation is counted so the bus cost of a
+ * primitive can be measured without hardware.
+ *
+ * GRAM is kept in MCU address space (gram[page][column]) exactly as addressed
+ * by CASET/PASET. MADCTL is recorded but the panel mirroring it selects is not
+ * applied. The scanout helpers apply vertical scrolling and inversion.
+ */
+
+#ifndef __ILI9341_EMU_H__
+#define __ILI9341_EMU_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ili9341.h"
+
+  // number of emulators that can be bound to a hw interface at once
+  #define ILI9341_EMU_MAX_INSTANCES   4
+  // longest parameter list decoded by the emulator
+  #define ILI9341_EMU_MAX_PARAMS      16
+  // sendbuf transfers that can be in flight at once in deferred mode
+  #define ILI9341_EMU_MAX_PENDING     8
+
+  /** @struct Hook and bus counters */
+  typedef struct {
+    uint32_t sendbyte_calls;      // sendbyte hook invocations
+    uint32_t sendbuf_calls;       // sendbuf hook invocations
+    uint32_t sendbuf_bytes;       // bytes transferred by sendbuf
+    uint32_t commit_calls;        // commit hook invocations
+    uint32_t barrier_calls;       // barrier hook invocations
+    uint32_t dc_calls;            // dc_pin hook invocations
+    uint32_t dc_toggles;          // D/C level changes
+    uint32_t cs_calls;            // cs_pin hook invocations
+    uint32_t cs_toggles;          // CS level changes
+    uint32_t reset_calls;         // reset_pin hook invocations
+    uint32_t delay_calls;         // delay hook invocations
+    uint64_t delay_us;            // total requested delay in microseconds
+    uint32_t cmd_bytes;           // bytes clocked with D/C low
+    uint32_t data_bytes;          // bytes clocked with D/C high
+    uint32_t pixels;              // pixels stored into GRAM
+    uint32_t clipped_pixels;      // pixels addressed outside of GRAM
+    uint32_t dropped_bytes;       // bytes clocked while CS was high or in reset
+    uint32_t barrier_violations;  // control lines changed while a sendbuf transfer was in flight
+    uint32_t cmd_count[256];      // occurrences of every command opcode
+  } ili9341_emu_stats_t;
+
+  /** @struct Emulated panel */
+  typedef struct {
+    // frame memory, native 565 words
+    uint16_t gram[ILI9341_MAX_Y][ILI9341_MAX_X];
+    // counters
+    ili9341_emu_stats_t stats;
+
+    // line levels
+    ili9341_dc_e dc;
+    ili9341_cs_e cs;
+    ili9341_reset_e reset;
+
+    // command decoder
+    uint8_t cmd;
+    uint8_t nparams;
+    uint8_t params[ILI9341_EMU_MAX_PARAMS];
+    uint8_t px_bytes[3];
+    uint8_t px_fill;
+    uint16_t x, y;
+
+    // sendbuf transfers in flight, deferred mode only
+    bool deferred;
+    ili9341_buf_t pending[ILI9341_EMU_MAX_PENDING];
+    uint8_t npending;
+
+    // registers
+    uint16_t sc, ec;              // column address set
+    uint16_t sp, ep;              // page address set
+    uint8_t madctl;
+    uint8_t colmod;
+    uint16_t tfa, vsa, bfa;       // vertical scrolling definition
+    uint16_t vsp;                 // vertical scrolling start address
+    bool inverted;
+    bool sleeping;
+    bool display_on;
+
+    // hw interface bound to this instance
+    int8_t slot;
+    ili9341_hw_intf_t intf;
+  } ili9341_emu_t;
+
+  /**
+   * @desc    Powers the emulator up: clears GRAM and counters, loads register defaults
+   *          and binds a hw interface slot
+   *
+   * @param   ili9341_emu_t* emu
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if all slots are taken
+   */
+  char ili9341_emu_init (ili9341_emu_t *emu);
+
+  /**
+   * @desc    Releases the hw interface slot bound by ili9341_emu_init
+   *
+   * @param   ili9341_emu_t* emu
+   *
+   * @return  void
+   */
+  void ili9341_emu_release (ili9341_emu_t *emu);
+
+  /**
+   * @desc    Returns the hw interface feeding this emulator, ready for ili9341_set_hw_intf()
+   *
+   * @param   ili9341_emu_t* emu
+   *
+   * @return  const ili9341_hw_intf_t*
+   */
+  const ili9341_hw_intf_t *ili9341_emu_intf (ili9341_emu_t *emu);
+
+  /**
+   * @desc    Deferred mode behaves like a DMA transport: buffers passed to sendbuf are only read
+   *          when barrier is called (or a later sendbyte needs the bus), so a driver that touches a
+   *          buffer in flight renders wrong pixels, and a D/C, CS or reset change while a transfer is
+   *          in flight is counted as a barrier violation.
+   *
+   * @param   ili9341_emu_t* emu
+   * @param   bool deferred
+   *
+   * @return  void
+   */
+  void ili9341_emu_set_deferred (ili9341_emu_t *emu, bool deferred);
+
+  /**
+   * @desc    Completes the transfers in flight without counting a barrier call
+   *
+   * @param   ili9341_emu_t* emu
+   *
+   * @return  void
+   */
+  void ili9341_emu_complete (ili9341_emu_t *emu);
+
+  /**
+   * @desc    Zeroes all counters, GRAM and registers are kept
+   *
+   * @param   ili9341_emu_t* emu
+   *
+   * @return  void
+   */
+  void ili9341_emu_reset_stats (ili9341_emu_t *emu);
+
+  /**
+   * @desc    Fills GRAM with a single color without touching counters
+   *
+   * @param   ili9341_emu_t* emu
+   * @param   uint16_t color565
+   *
+   * @return  void
+   */
+  void ili9341_emu_fill (ili9341_emu_t *emu, uint16_t color565);
+
+  /**
+   * @desc    Reads GRAM at a column / page address
+   *
+   * @param   const ili9341_emu_t* emu
+   * @param   uint16_t x column
+   * @param   uint16_t y page
+   *
+   * @return  uint16_t 565 color, 0 if out of range
+   */
+  uint16_t ili9341_emu_pixel (const ili9341_emu_t *emu, uint16_t x, uint16_t y);
+
+  /**
+   * @desc    Reads the color shown on a panel line, applying vertical scrolling and inversion
+   *
+   * @param   const ili9341_emu_t* emu
+   * @param   uint16_t x column
+   * @param   uint16_t line panel line
+   *
+   * @return  uint16_t 565 color, 0 if out of range
+   */
+  uint16_t ili9341_emu_scanout (const ili9341_emu_t *emu, uint16_t x, uint16_t line);
+
+  /**
+   * @desc    CRC-32 of the whole GRAM, useful for pixel-exact comparisons
+   *
+   * @param   const ili9341_emu_t* emu
+   *
+   * @return  uint32_t
+   */
+  uint32_t ili9341_emu_crc32 (const ili9341_emu_t *emu);
+
+  /**
+   * @desc    Writes the scanout as a binary PPM (P6) image
+   *
+   * @param   const ili9341_emu_t* emu
+   * @param   const char* path
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR on I/O failure
+   */
+  char ili9341_emu_write_ppm (const ili9341_emu_t *emu, const char *path);
+
+  // Hook implementations, callable directly when the driver is bound statically
+  // ---------------------------------------------------------------
+  void ili9341_emu_reset_pin (ili9341_emu_t *emu, ili9341_reset_e level);
+  void ili9341_emu_dc_pin (ili9341_emu_t *emu, ili9341_dc_e level);
+  void ili9341_emu_cs_pin (ili9341_emu_t *emu, ili9341_cs_e level);
+  void ili9341_emu_delay (ili9341_emu_t *emu, uint32_t us);
+  void ili9341_emu_sendbuf (ili9341_emu_t *emu, const ili9341_buf_t *buf);
+  void ili9341_emu_sendbyte (ili9341_emu_t *emu, uint8_t byte);
+  void ili9341_emu_commit (ili9341_emu_t *emu);
+  void ili9341_emu_barrier (ili9341_emu_t *emu);
+
+#endif
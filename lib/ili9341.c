@@ -20,11 +20,33 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include "font.h"
 #include "ili9341.h"
+#include "ili9341_pixel.h"
 
 /* Forward declarations */
-static void writePx(uint32_t color565);
+static void writePx(ili9341_t *lcd, uint32_t color565);
+static void sendColor(ili9341_t *lcd, uint16_t color, uint32_t count);
+static void sendColorBuf(ili9341_t *lcd, uint16_t color, uint32_t count);
+static void sendPattern(ili9341_t *lcd, uint8_t *pattern, uint16_t len, uint16_t start, uint32_t bytes);
+static void transmitCmmd(ili9341_t *lcd, uint8_t cmmd);
+static void shadowUpdate(ili9341_t *lcd, uint8_t cmmd, const uint8_t *args, uint8_t nargs);
+static void drawSpan(ili9341_t *lcd, uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye, uint16_t color);
+static void busWindow(ili9341_t *lcd, uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye);
+static void scrollWindow(ili9341_t *lcd);
+static uint16_t scrollRun(const ili9341_t *lcd, uint16_t y, uint16_t ye);
+static uint32_t scrollPixels(const ili9341_t *lcd);
+static void scrollNext(ili9341_t *lcd);
+#ifdef ILI9341_FRAMEBUFFER
+static void memStart(ili9341_t *lcd);
+static void memWrite(ili9341_t *lcd, const uint8_t *bytes, uint32_t len);
+static void memFill(ili9341_t *lcd, uint16_t color, uint32_t count);
+#endif
+
+#if (ILI9341_STREAM_BUF_LEN < 2) || (ILI9341_STREAM_BUF_LEN & 1) || (ILI9341_STREAM_BUF_LEN > 65534)
+  #error "ILI9341_STREAM_BUF_LEN must be even, between 2 and 65534"
+#endif
 
 /** @array Init command */
 const uint8_t INIT_ILI9341[] = {
@@ -73,158 +95,437 @@ const uint8_t INIT_ILI9341[] = {
   0, 200, ILI9341_DISPON                                        // 0x29 -> Display on
 };
 
-/** @var array Chache memory char index row */
-uint8_t _ili9341_cache_index_row = 0;
-/** @var array Chache memory char index column */
-uint8_t _ili9341_cache_index_col = 0;
+/** @var Instance behind the ILI9341_* functions */
+static ili9341_t _ili9341_default;
+
+#ifdef ILI9341_STATIC_HAL
+  // hooks bound at build time, missing ones are no-ops
+  #include ILI9341_STATIC_HAL
+
+  #ifndef ILI9341_HAL_RESET_PIN
+    #define ILI9341_HAL_RESET_PIN(lcd, level) ((void) (level))
+  #endif
+  #ifndef ILI9341_HAL_DC_PIN
+    #define ILI9341_HAL_DC_PIN(lcd, level) ((void) (level))
+  #endif
+  #ifndef ILI9341_HAL_CS_PIN
+    #define ILI9341_HAL_CS_PIN(lcd, level) ((void) (level))
+  #endif
+  #ifndef ILI9341_HAL_DELAY
+    #define ILI9341_HAL_DELAY(lcd, us) ((void) (us))
+  #endif
+  #ifdef ILI9341_HAL_SENDBUF
+    #define _HAL_HAS_sendbuf 1
+  #else
+    #define _HAL_HAS_sendbuf 0
+    #define ILI9341_HAL_SENDBUF(lcd, buf) ((void) (buf))
+  #endif
+  #ifndef ILI9341_HAL_SENDBYTE
+    #define ILI9341_HAL_SENDBYTE(lcd, byte) ((void) (byte))
+  #endif
+  #ifndef ILI9341_HAL_COMMIT
+    #define ILI9341_HAL_COMMIT(lcd, unused) ((void) (unused))
+  #endif
+  #ifndef ILI9341_HAL_BARRIER
+    #define ILI9341_HAL_BARRIER(lcd, unused) ((void) (unused))
+  #endif
+
+  // hook name -> HAL macro
+  #define _HAL_reset_pin  ILI9341_HAL_RESET_PIN
+  #define _HAL_dc_pin     ILI9341_HAL_DC_PIN
+  #define _HAL_cs_pin     ILI9341_HAL_CS_PIN
+  #define _HAL_delay      ILI9341_HAL_DELAY
+  #define _HAL_sendbuf    ILI9341_HAL_SENDBUF
+  #define _HAL_sendbyte   ILI9341_HAL_SENDBYTE
+  #define _HAL_commit     ILI9341_HAL_COMMIT
+  #define _HAL_barrier    ILI9341_HAL_BARRIER
+
+  #define _HW_HOOK(lcd, func, param) \
+    _HAL_##func(lcd, param);
+
+  #define _HW_HAS(lcd, func) (_HAL_HAS_##func)
+#else
+  #define _HW_HOOK(lcd, func, param) \
+    if(lcd->hw_intf && lcd->hw_intf->func) lcd->hw_intf->func(param);
+
+  #define _HW_HAS(lcd, func) (lcd->hw_intf && lcd->hw_intf->func)
+#endif
+
+#define _SHADOW_CASET     0x01
+#define _SHADOW_PASET     0x02
+#define _SHADOW_MADCTL    0x04
+#define _SHADOW_COLMOD    0x08
+#define _SHADOW_INVERSION 0x10
+
+/* Resumable init states */
+#define _BOOT_CS_HIGH     0
+#define _BOOT_CS_LOW      1
+#define _BOOT_RESET_LOW   2
+#define _BOOT_RESET_HIGH  3
+#define _BOOT_COMMANDS    4
+#define _BOOT_DONE        5
 
-static const ili9341_hw_intf_t *_hw_intf = NULL;
+/**
+ * @desc    Prepares a driver instance for a panel. Nothing is sent to the panel.
+ *
+ * @param   ili9341_t* lcd
+ * @param   const ili9341_hw_intf_t* hw_intf
+ *
+ * @return  void
+ */
+void ili9341_ctx_init (ili9341_t *lcd, const ili9341_hw_intf_t *hw_intf)
+{
+  memset(lcd, 0, sizeof(*lcd));
+  lcd->hw_intf = hw_intf;
+}
 
-void ili9341_set_hw_intf(const ili9341_hw_intf_t *hw_intf) {
-  _hw_intf = hw_intf;
+/**
+ * @desc    Returns the instance the ILI9341_* functions operate on
+ *
+ * @param   void
+ *
+ * @return  ili9341_t*
+ */
+ili9341_t *ili9341_default (void)
+{
+  return &_ili9341_default;
 }
 
-#define _HW_HOOK(func, param) \
-  if(_hw_intf && _hw_intf->func) _hw_intf->func(param);
+void ili9341_set_hw_intf(const ili9341_hw_intf_t *hw_intf) {
+  _ili9341_default.hw_intf = hw_intf;
+}
 
 /* Selects the device in data mode */
-void ILI9341_SetData(void) {
-  _HW_HOOK(barrier, NULL)
-  _HW_HOOK(dc_pin, DC_HIGH_DATA)
-  _HW_HOOK(cs_pin, CS_LOW_ON)
+void ili9341_set_data(ili9341_t *lcd) {
+  _HW_HOOK(lcd, barrier, NULL)
+  _HW_HOOK(lcd, dc_pin, DC_HIGH_DATA)
+  _HW_HOOK(lcd, cs_pin, CS_LOW_ON)
+}
+
+/* Waits for the transfers in flight */
+void ili9341_barrier(ili9341_t *lcd) {
+  _HW_HOOK(lcd, barrier, NULL)
 }
 
 
 /**
  * @desc    LCD init
  *
- * @param   void
+ * @param   ili9341_t* lcd
  *
  * @return  void
  */
-void ILI9341_Init (void)
+void ili9341_init (ili9341_t *lcd)
 {
-  // variables
-  const uint8_t *commands = INIT_ILI9341;
+  uint32_t wait;
+
+  ili9341_init_start(lcd, ILI9341_BOOT_NORMAL);
+  // wait out every delay of the sequence
+  while ((wait = ili9341_init_step(lcd)) != ILI9341_INIT_DONE) {
+    _HW_HOOK(lcd, delay, wait)
+  }
+}
+
+/**
+ * @desc    Prepares the resumable init, nothing is sent
+ *
+ * @param   ili9341_t* lcd
+ * @param   ILI9341_Boot profile
+ *
+ * @return  void
+ */
+void ili9341_init_start (ili9341_t *lcd, ILI9341_Boot profile)
+{
+  lcd->boot.state = _BOOT_CS_HIGH;
+  lcd->boot.profile = profile;
   // number of commands
-  uint8_t no_of_commands = *(commands++);
+  lcd->boot.left = INIT_ILI9341[0];
+  lcd->boot.next = INIT_ILI9341 + 1;
+  // the reset takes the panel out of any scrolling
+  lcd->scroll.tfa = 0;
+  lcd->scroll.vsa = 0;
+  lcd->scroll.off = 0;
+}
+
+/**
+ * @desc    Delay in ms after a command of INIT_ILI9341 in the active profile
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint8_t command
+ * @param   uint8_t delay from INIT_ILI9341
+ *
+ * @return  uint8_t
+ */
+static uint8_t bootDelay(ili9341_t *lcd, uint8_t command, uint8_t delay)
+{
+  if (lcd->boot.profile != ILI9341_BOOT_FAST) {
+    return delay;
+  }
+  switch (command) {
+    // next command may follow 5 ms after SLPOUT
+    case ILI9341_SLPOUT:
+      return 5;
+    // display is on at once
+    case ILI9341_DISPON:
+      return 0;
+  }
+  return delay;
+}
+
+/**
+ * @desc    Runs the init sequence up to the next delay
+ *
+ * @param   ili9341_t* lcd
+ *
+ * @return  uint32_t microseconds to wait, ILI9341_INIT_DONE when finished
+ */
+uint32_t ili9341_init_step (ili9341_t *lcd)
+{
+  bool fast = lcd->boot.profile == ILI9341_BOOT_FAST;
   // arguments
-  char no_of_arguments;
+  uint8_t no_of_arguments;
   // command
-  char command;
+  uint8_t command;
   // delay
   uint8_t delay;
 
-  // Init hardware reset
-  ILI9341_HWReset();
-
-  // loop throuh commands
-  while (no_of_commands--) {
-    // number of arguments
-    no_of_arguments = *(commands++);
-    // delay
-    delay = *(commands++);
-    // command
-    command = *(commands++);
-    // send command
-    // -------------------------    
-    ILI9341_TransmitCmmd(command);
-    // send arguments
-    // -------------------------
-    ILI9341_SetData();
-    while (no_of_arguments--) {
-      // send arguments
-      ILI9341_Transmit8bitData(*(commands++));
-    }
-    _HW_HOOK(commit, NULL);
-    // delay
-    _HW_HOOK(delay, delay*1000);
+  switch (lcd->boot.state) {
+    // RESET SEQUENCE
+    case _BOOT_CS_HIGH:
+      // set CS HIGH
+      _HW_HOOK(lcd, cs_pin, CS_HIGH_OFF)
+      lcd->boot.state = _BOOT_CS_LOW;
+      if (!fast) {
+        return 1000;
+      }
+      // fall through
+    case _BOOT_CS_LOW:
+      _HW_HOOK(lcd, cs_pin, CS_LOW_ON)
+      lcd->boot.state = _BOOT_RESET_LOW;
+      if (!fast) {
+        return 1000;
+      }
+      // fall through
+    case _BOOT_RESET_LOW:
+      // set Reset LOW, delay LOW > 10us
+      _HW_HOOK(lcd, reset_pin, RESET_LOW_SET)
+      lcd->boot.state = _BOOT_RESET_HIGH;
+      return 10;
+    case _BOOT_RESET_HIGH:
+      // set Reset HIGH, delay HIGH > 120ms (SLPOUT may not follow sooner)
+      _HW_HOOK(lcd, reset_pin, RESET_HIGH_NOTSET)
+      // registers are back at their defaults, forget what was sent before
+      ili9341_invalidate_shadow(lcd);
+      lcd->boot.state = _BOOT_COMMANDS;
+      return 120000;
+    case _BOOT_COMMANDS:
+      // loop throuh commands
+      while (lcd->boot.left) {
+        lcd->boot.left--;
+        // number of arguments
+        no_of_arguments = *(lcd->boot.next++);
+        // delay
+        delay = *(lcd->boot.next++);
+        // command
+        command = *(lcd->boot.next++);
+        // the hardware reset already did it
+        if (fast && command == ILI9341_SWRESET) {
+          lcd->boot.next += no_of_arguments;
+          continue;
+        }
+        // keep track of the registers the command sets
+        shadowUpdate(lcd, command, lcd->boot.next, no_of_arguments);
+        // send command
+        // -------------------------
+        transmitCmmd(lcd, command);
+        // send arguments
+        // -------------------------
+        ili9341_set_data(lcd);
+        while (no_of_arguments--) {
+          // send arguments
+          ili9341_transmit_8bit_data(lcd, *(lcd->boot.next++));
+        }
+        _HW_HOOK(lcd, commit, NULL);
+        // delay
+        delay = bootDelay(lcd, command, delay);
+        if (delay) {
+          return delay * 1000UL;
+        }
+      }
+      // set window -> after this function display show RAM content
+      ili9341_set_window(lcd, 0, 0, ILI9341_MAX_X-1, ILI9341_MAX_Y-1);
+      lcd->boot.state = _BOOT_DONE;
+      // fall through
+    default:
+      return ILI9341_INIT_DONE;
   }
-  // set window -> after this function display show RAM content
-  ILI9341_SetWindow(0, 0, ILI9341_MAX_X-1, ILI9341_MAX_Y-1);
 }
 
 /**
  * @desc    LCD Hardware Reset
  *
- * @param   void
+ * @param   ili9341_t* lcd
  *
  * @return  void
  */
-void ILI9341_HWReset (void)
+void ili9341_hw_reset (ili9341_t *lcd)
 {
   // set RESET as Output
   // TODO: Does this need to be done in a pure implementation? Isn't it always output?
 
   // RESET SEQUENCE
   // set CS HIGH
-  _HW_HOOK(cs_pin, CS_HIGH_OFF)
-  _HW_HOOK(delay, 1000)
-  _HW_HOOK(cs_pin, CS_LOW_ON)
-  _HW_HOOK(delay, 1000)
+  _HW_HOOK(lcd, cs_pin, CS_HIGH_OFF)
+  _HW_HOOK(lcd, delay, 1000)
+  _HW_HOOK(lcd, cs_pin, CS_LOW_ON)
+  _HW_HOOK(lcd, delay, 1000)
   // --------------------------------------------
   // set Reset LOW
-  _HW_HOOK(reset_pin, RESET_LOW_SET)
+  _HW_HOOK(lcd, reset_pin, RESET_LOW_SET)
 
   // delay LOW > 10us
-  _HW_HOOK(delay, 10)
+  _HW_HOOK(lcd, delay, 10)
   // set Reset HIGH
-  _HW_HOOK(reset_pin, RESET_HIGH_NOTSET)
+  _HW_HOOK(lcd, reset_pin, RESET_HIGH_NOTSET)
 
   // delay HIGH > 120ms
-  _HW_HOOK(delay, 120000)
+  _HW_HOOK(lcd, delay, 120000)
+
+  // registers are back at their defaults, forget what was sent before
+  ili9341_invalidate_shadow(lcd);
+}
+
+/**
+ * @desc    Forgets the shadowed register values, the next commands are sent unconditionally
+ *
+ * @param   ili9341_t* lcd
+ *
+ * @return  void
+ */
+void ili9341_invalidate_shadow (ili9341_t *lcd)
+{
+  lcd->shadow.valid = 0;
+}
+
+/**
+ * @desc    Updates the register shadow for a command about to be sent
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint8_t cmmd The command
+ * @param   const uint8_t* args Its parameters, NULL if not known to the driver
+ * @param   uint8_t nargs Number of parameters in args
+ *
+ * @return  void
+ */
+static void shadowUpdate(ili9341_t *lcd, uint8_t cmmd, const uint8_t *args, uint8_t nargs)
+{
+  switch (cmmd) {
+    case ILI9341_SWRESET:
+      lcd->shadow.valid = 0;
+      lcd->scroll.tfa = 0;
+      lcd->scroll.vsa = 0;
+      lcd->scroll.off = 0;
+      break;
+    case ILI9341_CASET:
+      lcd->shadow.valid &= ~_SHADOW_CASET;
+      break;
+    case ILI9341_PASET:
+      lcd->shadow.valid &= ~_SHADOW_PASET;
+      break;
+    case ILI9341_MADCTL:
+      lcd->shadow.valid &= ~_SHADOW_MADCTL;
+      if (args && nargs) {
+        lcd->shadow.madctl = args[0];
+        lcd->shadow.valid |= _SHADOW_MADCTL;
+      }
+      break;
+    case ILI9341_COLMOD:
+      lcd->shadow.valid &= ~_SHADOW_COLMOD;
+      if (args && nargs) {
+        lcd->shadow.colmod = args[0];
+        lcd->shadow.valid |= _SHADOW_COLMOD;
+      }
+      break;
+    case ILI9341_DINVON:
+    case ILI9341_DINVOFF:
+      lcd->shadow.inverted = (cmmd == ILI9341_DINVON);
+      lcd->shadow.valid |= _SHADOW_INVERSION;
+      break;
+    default:
+      break;
+  }
 }
 
 /**
  * @desc    LCD Transmit Command
- *          This function sends its data immediately and manipulates the D/C wire
+ *          This function sends its data immediately and manipulates the D/C wire.
+ *          The parameters that follow are not seen by the driver, so the shadow of
+ *          the register the command writes is dropped.
  *
+ * @param   ili9341_t* lcd
  * @param   uint8_t
  *
  * @return  void
  */
-void ILI9341_TransmitCmmd (uint8_t cmmd)
+void ili9341_transmit_cmmd (ili9341_t *lcd, uint8_t cmmd)
+{
+  shadowUpdate(lcd, cmmd, NULL, 0);
+  transmitCmmd(lcd, cmmd);
+}
+
+/**
+ * @desc    Transmits a command without touching the register shadow
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint8_t
+ *
+ * @return  void
+ */
+static void transmitCmmd (ili9341_t *lcd, uint8_t cmmd)
 {
-  _HW_HOOK(barrier, NULL)
-  _HW_HOOK(dc_pin, DC_LOW_CMD)
-  _HW_HOOK(sendbyte, cmmd)
-  _HW_HOOK(commit, NULL)
+  _HW_HOOK(lcd, barrier, NULL)
+  _HW_HOOK(lcd, dc_pin, DC_LOW_CMD)
+  _HW_HOOK(lcd, sendbyte, cmmd)
+  _HW_HOOK(lcd, commit, NULL)
 }
 
 /**
  * @desc    LCD transmit 8 bits data
  *
+ * @param   ili9341_t* lcd
  * @param   uint8_t
  *
  * @return  void
  */
-void ILI9341_Transmit8bitData (uint8_t data)
+void ili9341_transmit_8bit_data (ili9341_t *lcd, uint8_t data)
 {
   // set data on PORT
-  _HW_HOOK(sendbyte, data)
+  _HW_HOOK(lcd, sendbyte, data)
 }
 
 /**
  * @desc    LCD transmit 16 bits data
  *
+ * @param   ili9341_t* lcd
  * @param   uint16_t
  *
  * @return  void
  */
-void ILI9341_Transmit16bitData (uint16_t data)
+void ili9341_transmit_16bit_data (ili9341_t *lcd, uint16_t data)
 {
-  _HW_HOOK(sendbyte, data >> 8)
-  _HW_HOOK(sendbyte, data)
+  _HW_HOOK(lcd, sendbyte, data >> 8)
+  _HW_HOOK(lcd, sendbyte, data)
 }
 
 /**
  * @desc    LCD transmit 32 bits data
  *
+ * @param   ili9341_t* lcd
  * @param   uint16_t
  *
  * @return  void
  */
-void ILI9341_Transmit32bitData (uint32_t data)
+void ili9341_transmit_32bit_data (ili9341_t *lcd, uint32_t data)
 {
   // Write data timing diagram
   // --------------------------------------------
@@ -237,15 +538,16 @@ void ILI9341_Transmit32bitData (uint32_t data)
   //   __
   // 0x00000000
 
-  _HW_HOOK(sendbyte, data >> 24)
-  _HW_HOOK(sendbyte, data >> 16)
-  _HW_HOOK(sendbyte, data >> 8)
-  _HW_HOOK(sendbyte, data)
+  _HW_HOOK(lcd, sendbyte, data >> 24)
+  _HW_HOOK(lcd, sendbyte, data >> 16)
+  _HW_HOOK(lcd, sendbyte, data >> 8)
+  _HW_HOOK(lcd, sendbyte, data)
 }
 
 /**
  * @desc    LCD Set address window
  *
+ * @param   ili9341_t* lcd
  * @param   uint16_t
  * @param   uint16_t
  * @param   uint16_t
@@ -253,7 +555,7 @@ void ILI9341_Transmit32bitData (uint32_t data)
  *
  * @return  char
  */
-char ILI9341_SetWindow (uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
+char ili9341_set_window (ili9341_t *lcd, uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
 {
   // check if coordinates is out of range
   if ((xs > xe) || (xe > ILI9341_SIZE_X) ||
@@ -263,27 +565,163 @@ char ILI9341_SetWindow (uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
     return ILI9341_ERROR;
   }  
 
-  // set column
-  ILI9341_TransmitCmmd(ILI9341_CASET);
-  // set column -> set column
-  ILI9341_SetData();
-  ILI9341_Transmit32bitData(((uint32_t) xs << 16) | xe);
-  _HW_HOOK(commit, NULL)
-  // set page
-  ILI9341_TransmitCmmd(ILI9341_PASET);
-  // set page -> high byte first
-  ILI9341_SetData();
-  ILI9341_Transmit32bitData(((uint32_t) ys << 16) | ye);
-  _HW_HOOK(commit, NULL)
+  // screen window, written from its first row on
+  lcd->scroll.xs = xs;
+  lcd->scroll.ys = ys;
+  lcd->scroll.xe = xe;
+  lcd->scroll.ye = ye;
+  lcd->scroll.row = ys;
+  scrollWindow(lcd);
   // success
   return ILI9341_SUCCESS;
 }
 
-char ILI9341_DrawRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
-  if (ILI9341_SetWindow(x, y, x+w-1, y+h-1) != ILI9341_SUCCESS) {
+/**
+ * @desc    GRAM row shown on a screen row
+ *
+ * @param   const ili9341_t* lcd
+ * @param   uint16_t y
+ *
+ * @return  uint16_t
+ */
+static uint16_t scrollPage(const ili9341_t *lcd, uint16_t y)
+{
+  uint16_t end = lcd->scroll.tfa + lcd->scroll.vsa;
+
+  // fixed areas are not moved
+  if (y < lcd->scroll.tfa || y >= end) {
+    return y;
+  }
+  y += lcd->scroll.off;
+  return (y >= end) ? y - lcd->scroll.vsa : y;
+}
+
+/**
+ * @desc    Last screen row, up to ye, whose GRAM rows follow on from the one of row y. A scrolled area
+ *          breaks the rows at its top and bottom edge and where its GRAM rows wrap around.
+ *
+ * @param   const ili9341_t* lcd
+ * @param   uint16_t y
+ * @param   uint16_t ye
+ *
+ * @return  uint16_t
+ */
+static uint16_t scrollRun(const ili9341_t *lcd, uint16_t y, uint16_t ye)
+{
+  uint16_t end = lcd->scroll.tfa + lcd->scroll.vsa;
+  uint16_t edge;
+
+  if (!lcd->scroll.off || y >= end) {
+    return ye;
+  }
+  if (y < lcd->scroll.tfa) {
+    edge = lcd->scroll.tfa;
+  } else if (y < end - lcd->scroll.off) {
+    edge = end - lcd->scroll.off;
+  } else {
+    edge = end;
+  }
+  return (edge - 1 < ye) ? edge - 1 : ye;
+}
+
+/**
+ * @desc    Sets the GRAM window of the part of the screen window being written
+ *
+ * @param   ili9341_t* lcd
+ *
+ * @return  void
+ */
+static void scrollWindow(ili9341_t *lcd)
+{
+  uint16_t ys = scrollPage(lcd, lcd->scroll.row);
+  uint16_t ye = scrollPage(lcd, scrollRun(lcd, lcd->scroll.row, lcd->scroll.ye));
+
+#ifdef ILI9341_FRAMEBUFFER
+  // off-screen, the window only addresses the framebuffer
+  if (lcd->fb) {
+    lcd->fb_win.xs = lcd->scroll.xs;
+    lcd->fb_win.ys = ys;
+    lcd->fb_win.xe = lcd->scroll.xe;
+    lcd->fb_win.ye = ye;
+    return;
+  }
+#endif
+  busWindow(lcd, lcd->scroll.xs, ys, lcd->scroll.xe, ye);
+}
+
+/**
+ * @desc    Pixels of the part of the screen window being written
+ *
+ * @param   const ili9341_t* lcd
+ *
+ * @return  uint32_t
+ */
+static uint32_t scrollPixels(const ili9341_t *lcd)
+{
+  uint16_t ye = scrollRun(lcd, lcd->scroll.row, lcd->scroll.ye);
+
+  return (uint32_t) (lcd->scroll.xe - lcd->scroll.xs + 1) * (ye - lcd->scroll.row + 1);
+}
+
+/**
+ * @desc    Moves on to the next part of the screen window, back to the first one after the last
+ *          like the address counter does
+ *
+ * @param   ili9341_t* lcd
+ *
+ * @return  void
+ */
+static void scrollNext(ili9341_t *lcd)
+{
+  lcd->scroll.row = scrollRun(lcd, lcd->scroll.row, lcd->scroll.ye) + 1;
+  if (lcd->scroll.row > lcd->scroll.ye) {
+    lcd->scroll.row = lcd->scroll.ys;
+  }
+  scrollWindow(lcd);
+}
+
+/**
+ * @desc    Sends CASET and PASET for a window checked by the caller
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t xs
+ * @param   uint16_t ys
+ * @param   uint16_t xe
+ * @param   uint16_t ye
+ *
+ * @return  void
+ */
+static void busWindow (ili9341_t *lcd, uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
+{
+  // set column, unless the controller already holds it
+  if (!(lcd->shadow.valid & _SHADOW_CASET) || (lcd->shadow.xs != xs) || (lcd->shadow.xe != xe)) {
+    transmitCmmd(lcd, ILI9341_CASET);
+    // set column -> set column
+    ili9341_set_data(lcd);
+    ili9341_transmit_32bit_data(lcd, ((uint32_t) xs << 16) | xe);
+    _HW_HOOK(lcd, commit, NULL)
+    lcd->shadow.xs = xs;
+    lcd->shadow.xe = xe;
+    lcd->shadow.valid |= _SHADOW_CASET;
+  }
+  // set page, unless the controller already holds it
+  if (!(lcd->shadow.valid & _SHADOW_PASET) || (lcd->shadow.ys != ys) || (lcd->shadow.ye != ye)) {
+    transmitCmmd(lcd, ILI9341_PASET);
+    // set page -> high byte first
+    ili9341_set_data(lcd);
+    ili9341_transmit_32bit_data(lcd, ((uint32_t) ys << 16) | ye);
+    _HW_HOOK(lcd, commit, NULL)
+    lcd->shadow.ys = ys;
+    lcd->shadow.ye = ye;
+    lcd->shadow.valid |= _SHADOW_PASET;
+  }
+}
+
+char ili9341_draw_rect(ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+  if (ili9341_set_window(lcd, x, y, x+w-1, y+h-1) != ILI9341_SUCCESS) {
   return ILI9341_ERROR;
   }
-  ILI9341_SendColor565(color, w*h);
+  ili9341_send_color565(lcd, color, w*h);
   return ILI9341_SUCCESS;
 }
 
@@ -292,13 +730,14 @@ char ILI9341_DrawRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c
  * @desc    Sends a single pixel to the LCD. This process has a substantial amount of overhead per pixel
  *          and should be avoided.
  *
+ * @param   ili9341_t* lcd
  * @param   uint16_t x The X position of the pixel
  * @param   uint16_t y The y position of the pixel
  * @param   uint16_t color The 565 color of the pixel
  *
  * @return  ILI9341_SUCCESS on success, ILI9341_ERROR on bad params
  */
-char ILI9341_DrawPixel (uint16_t x, uint16_t y, uint16_t color)
+char ili9341_draw_pixel (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t color)
 {
   // check dimension
   if ((x > ILI9341_SIZE_X) || (y > ILI9341_SIZE_Y)) {
@@ -306,12 +745,19 @@ char ILI9341_DrawPixel (uint16_t x, uint16_t y, uint16_t color)
     return ILI9341_ERROR;
   }
   // set window
-  ILI9341_SetWindow(x, y, x, y);
+  ili9341_set_window(lcd, x, y, x, y);
+#ifdef ILI9341_FRAMEBUFFER
+  if (lcd->fb) {
+    memStart(lcd);
+    memFill(lcd, color, 1);
+    return ILI9341_SUCCESS;
+  }
+#endif
   // draw pixel by 565 mode
-  ILI9341_TransmitCmmd(ILI9341_RAMWR);
-  ILI9341_SetData();
-  writePx(color);
-  _HW_HOOK(commit, NULL)
+  transmitCmmd(lcd, ILI9341_RAMWR);
+  ili9341_set_data(lcd);
+  writePx(lcd, color);
+  _HW_HOOK(lcd, commit, NULL)
   // success
   return ILI9341_SUCCESS;
 }
@@ -319,593 +765,2323 @@ char ILI9341_DrawPixel (uint16_t x, uint16_t y, uint16_t color)
 /**
  * @desc    LCD Write Color Pixels
  *
+ * @param   ili9341_t* lcd
  * @param   uint16_t
  * @param   uint32_t
  *
  * @return  void
  */
-void ILI9341_SendColor565 (uint16_t color, uint32_t count)
+void ili9341_send_color565 (ili9341_t *lcd, uint16_t color, uint32_t count)
+{
+  // a window crossing an edge of the scrolled area is written in parts
+  while (lcd->scroll.off && count > scrollPixels(lcd)) {
+    uint32_t part = scrollPixels(lcd);
+    sendColor(lcd, color, part);
+    count -= part;
+    scrollNext(lcd);
+  }
+  sendColor(lcd, color, count);
+}
+
+/**
+ * @desc    Writes count pixels of one color into the window, from its start
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t color
+ * @param   uint32_t count
+ *
+ * @return  void
+ */
+static void sendColor(ili9341_t *lcd, uint16_t color, uint32_t count)
 {
+#ifdef ILI9341_FRAMEBUFFER
+  if (lcd->fb) {
+    memStart(lcd);
+    memFill(lcd, color, count);
+    return;
+  }
+#endif
   // access to RAM
-  ILI9341_TransmitCmmd(ILI9341_RAMWR);
+  transmitCmmd(lcd, ILI9341_RAMWR);
 
-  ILI9341_SetData();
+  ili9341_set_data(lcd);
+  // bulk path, stream the repeated-color buffer
+  if (_HW_HAS(lcd, sendbuf)) {
+    sendColorBuf(lcd, color, count);
+    return;
+  }
   // counter
   for (uint32_t i=0; i<count; i++) {
-    writePx(color);
+    writePx(lcd, color);
+  }
+  _HW_HOOK(lcd, commit, NULL)
+}
+
+/**
+ * @desc    Streams count pixels of a single color through sendbuf. The buffer is only
+ *          rebuilt (after a barrier, it may be in flight) when the color changes.
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t color
+ * @param   uint32_t count
+ *
+ * @return  void
+ */
+static void sendColorBuf(ili9341_t *lcd, uint16_t color, uint32_t count)
+{
+  ili9341_buf_t buf = {.buf=lcd->fill_buf, .len=ILI9341_FILL_BUF_LEN};
+  uint32_t bytes = count*2;
+
+  if (!lcd->fill_valid || lcd->fill_color != color) {
+    _HW_HOOK(lcd, barrier, NULL)
+    for (uint16_t i=0; i<ILI9341_FILL_BUF_LEN; i+=2) {
+      ILI9341_RGB565_DECODETOBUF(lcd->fill_buf+i, color)
+    }
+    lcd->fill_color = color;
+    lcd->fill_valid = true;
+  }
+  while (bytes) {
+    /* Avoid oversending on the last pass */
+    if (bytes < buf.len) {
+      buf.len = bytes;
+    }
+    _HW_HOOK(lcd, sendbuf, &buf)
+    bytes -= buf.len;
   }
-  _HW_HOOK(commit, NULL)
 }
 
 /**
  * @desc    Clears the screen to a set color.
  *
+ * @param   ili9341_t* lcd
  * @param   uint16_t color
  *
  * @return  void
  */
-void ILI9341_ClearScreen (uint32_t color)
+void ili9341_clear_screen (ili9341_t *lcd, uint32_t color)
 {
   // set whole window
-  ILI9341_SetWindow(0, 0, ILI9341_SIZE_X, ILI9341_SIZE_Y);
+  ili9341_set_window(lcd, 0, 0, ILI9341_SIZE_X, ILI9341_SIZE_Y);
   // draw individual pixels
-  ILI9341_SendColor565(color, ILI9341_CACHE_MEM);
+  ili9341_send_color565(lcd, color, ILI9341_CACHE_MEM);
 }
 
-void ILI9341_WritePatternRect(uint8_t *pattern_buf, uint16_t len, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+void ili9341_write_pattern_rect(ili9341_t *lcd, uint8_t *pattern_buf, uint16_t len, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  uint32_t bytes = (uint32_t) w*h*2;
+  uint32_t sent = 0;
+
   if (!pattern_buf || !len || !w || !h) {
     return;
   }
 
-  ili9341_buf_t buf = {.buf=pattern_buf, .len=len};
-  ILI9341_SetWindow(x, y, x+w-1, y+h-1);
+  ili9341_set_window(lcd, x, y, x+w-1, y+h-1);
+  // a window crossing an edge of the scrolled area is written in parts, the pattern carries on
+  while (lcd->scroll.off && bytes - sent > scrollPixels(lcd)*2) {
+    uint32_t part = scrollPixels(lcd)*2;
+    sendPattern(lcd, pattern_buf, len, sent % len, part);
+    sent += part;
+    scrollNext(lcd);
+  }
+  sendPattern(lcd, pattern_buf, len, sent % len, bytes - sent);
+}
+
+/**
+ * @desc    Writes bytes of a repeated pattern into the window, from its start
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint8_t* pattern
+ * @param   uint16_t len of the pattern
+ * @param   uint16_t start offset into the pattern of the first byte
+ * @param   uint32_t bytes
+ *
+ * @return  void
+ */
+static void sendPattern(ili9341_t *lcd, uint8_t *pattern, uint16_t len, uint16_t start, uint32_t bytes)
+{
+  ili9341_buf_t buf;
+
+#ifdef ILI9341_FRAMEBUFFER
+  if (lcd->fb) {
+    memStart(lcd);
+    while (bytes) {
+      uint32_t run = (bytes < (uint32_t) (len - start)) ? bytes : (uint32_t) (len - start);
+      memWrite(lcd, pattern + start, run);
+      bytes -= run;
+      start = 0;
+    }
+    return;
+  }
+#endif
   /* Draw the screen based on repeating the buffer */
 
-  ILI9341_TransmitCmmd(ILI9341_RAMWR);
-  ILI9341_SetData();
-  for (unsigned i=0; i<w*h*2; i+=len) {
+  transmitCmmd(lcd, ILI9341_RAMWR);
+  ili9341_set_data(lcd);
+  // no sendbuf, the pattern goes out byte by byte
+  if (!_HW_HAS(lcd, sendbuf)) {
+    while (bytes--) {
+      _HW_HOOK(lcd, sendbyte, pattern[start])
+      if (++start == len) {
+        start = 0;
+      }
+    }
+    _HW_HOOK(lcd, commit, NULL)
+    return;
+  }
+  while (bytes) {
     /* Avoid oversending on the last pass if the buffers are not alligned */
-    if (i+len > w*h*2) {
-      buf.len = w*h*2 - i;
+    buf.buf = pattern + start;
+    buf.len = (bytes < (uint32_t) (len - start)) ? bytes : (uint32_t) (len - start);
+    _HW_HOOK(lcd, sendbuf, &buf)
+    bytes -= buf.len;
+    start = 0;
+  }
+  _HW_HOOK(lcd, barrier, NULL)
+}
+
+/**
+ * @desc    Streams a rectangle of rendered pixels through the ping-pong buffers
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t x
+ * @param   uint16_t y
+ * @param   uint16_t w
+ * @param   uint16_t h
+ * @param   ili9341_render_fn render
+ * @param   void* arg
+ *
+ * @return  char
+ */
+char ili9341_stream_rect (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, ili9341_render_fn render, void *arg)
+{
+  uint32_t bytes = (uint32_t) w*h*2;
+  ili9341_buf_t buf;
+
+  // check if the window is empty or out of range, before anything is rendered
+  if (!w || !h || ((uint32_t) x+w-1 > ILI9341_SIZE_X) || ((uint32_t) y+h-1 > ILI9341_SIZE_Y)) {
+    return ILI9341_ERROR;
+  }
+  // a window crossing an edge of the scrolled area is streamed in parts, the renderer carries on
+  if (lcd->scroll.off && scrollRun(lcd, y, y+h-1) < y+h-1) {
+    uint16_t rows = scrollRun(lcd, y, y+h-1) - y + 1;
+    ili9341_stream_rect(lcd, x, y, w, rows, render, arg);
+    return ili9341_stream_rect(lcd, x, y+rows, w, h-rows, render, arg);
+  }
+
+#ifdef ILI9341_FRAMEBUFFER
+  // off-screen, chunks are copied into the framebuffer through the buffer a direct stream
+  // before the attach did not leave in flight
+  if (lcd->fb) {
+    buf.buf = lcd->stream_buf[lcd->stream_cur];
+    ili9341_set_window(lcd, x, y, x+w-1, y+h-1);
+    memStart(lcd);
+    while (bytes) {
+      buf.len = (bytes < ILI9341_STREAM_BUF_LEN) ? bytes : ILI9341_STREAM_BUF_LEN;
+      render(arg, buf.buf, buf.len);
+      memWrite(lcd, buf.buf, buf.len);
+      bytes -= buf.len;
+    }
+    return ILI9341_SUCCESS;
+  }
+#endif
+
+  // no sendbuf, every chunk goes out byte by byte
+  if (!_HW_HAS(lcd, sendbuf)) {
+    ili9341_set_window(lcd, x, y, x+w-1, y+h-1);
+    transmitCmmd(lcd, ILI9341_RAMWR);
+    ili9341_set_data(lcd);
+    buf.buf = lcd->stream_buf[lcd->stream_cur];
+    while (bytes) {
+      buf.len = (bytes < ILI9341_STREAM_BUF_LEN) ? bytes : ILI9341_STREAM_BUF_LEN;
+      render(arg, buf.buf, buf.len);
+      for (uint16_t i=0; i<buf.len; i++) {
+        _HW_HOOK(lcd, sendbyte, buf.buf[i])
+      }
+      bytes -= buf.len;
     }
-    _HW_HOOK(sendbuf, &buf)
+    _HW_HOOK(lcd, commit, NULL)
+    return ILI9341_SUCCESS;
+  }
+
+  // the first chunk overlaps whatever is still in flight, the buffer sent last is left alone
+  buf.buf = lcd->stream_buf[lcd->stream_cur];
+  buf.len = (bytes < ILI9341_STREAM_BUF_LEN) ? bytes : ILI9341_STREAM_BUF_LEN;
+  render(arg, buf.buf, buf.len);
+
+  // window and RAMWR, their barrier ends the previous transfer
+  ili9341_set_window(lcd, x, y, x+w-1, y+h-1);
+  transmitCmmd(lcd, ILI9341_RAMWR);
+  ili9341_set_data(lcd);
+  _HW_HOOK(lcd, sendbuf, &buf)
+  bytes -= buf.len;
+
+  while (bytes) {
+    // render into the other buffer while this one is on the wire
+    lcd->stream_cur ^= 1;
+    buf.buf = lcd->stream_buf[lcd->stream_cur];
+    buf.len = (bytes < ILI9341_STREAM_BUF_LEN) ? bytes : ILI9341_STREAM_BUF_LEN;
+    render(arg, buf.buf, buf.len);
+    // previous chunk done, the buffer rendered next is free again
+    _HW_HOOK(lcd, barrier, NULL)
+    _HW_HOOK(lcd, sendbuf, &buf)
+    bytes -= buf.len;
   }
-  _HW_HOOK(barrier, NULL)
+  // the next stream starts with the buffer not in flight
+  lcd->stream_cur ^= 1;
+
+  return ILI9341_SUCCESS;
 }
 
+#ifdef ILI9341_FRAMEBUFFER
 /**
- * @desc    LCD Inverse Screen
+ * @desc    Redirects drawing into a framebuffer, NULL to draw to the panel again
  *
- * @param   void
+ * @param   ili9341_t* lcd
+ * @param   uint8_t* fb ILI9341_FB_SIZE bytes
  *
  * @return  void
  */
-void ILI9341_InverseScreen (void)
+void ili9341_attach_framebuffer (ili9341_t *lcd, uint8_t *fb)
 {
-  // display on
-  ILI9341_TransmitCmmd(ILI9341_DINVON);
+  // the old buffer may still be on its way to the panel
+  if (lcd->fb_inflight) {
+    _HW_HOOK(lcd, barrier, NULL)
+    lcd->fb_inflight = false;
+  }
+  lcd->fb = fb;
+  lcd->fb_ys = 0;
+  lcd->fb_ye = ILI9341_SIZE_Y;
+  lcd->ndirty = 0;
+  lcd->dirty_max = ILI9341_DIRTY_MAX;
+  lcd->fb_win.xs = 0;
+  lcd->fb_win.ys = 0;
+  lcd->fb_win.xe = ILI9341_SIZE_X;
+  lcd->fb_win.ye = ILI9341_SIZE_Y;
 }
 
 /**
- * @desc    LCD Normal Screen
+ * @desc    Redirects drawing into a strip of full-width rows, filled with a background color
  *
- * @param   void
+ * @param   ili9341_t* lcd
+ * @param   uint8_t* strip ILI9341_STRIP_SIZE(ye - ys + 1) bytes
+ * @param   uint16_t ys
+ * @param   uint16_t ye
+ * @param   uint16_t bg
  *
- * @return  void
+ * @return  char
  */
-void ILI9341_NormalScreen (void)
+char ili9341_attach_strip (ili9341_t *lcd, uint8_t *strip, uint16_t ys, uint16_t ye, uint16_t bg)
 {
-  // display on
-  ILI9341_TransmitCmmd(ILI9341_DINVOFF);
+  uint8_t px[2];
+  uint32_t bytes = ILI9341_STRIP_SIZE(ye - ys + 1);
+
+  if (strip == NULL || ys > ye || ye > ILI9341_SIZE_Y) {
+    return ILI9341_ERROR;
+  }
+  ili9341_attach_framebuffer(lcd, strip);
+  lcd->fb_ys = ys;
+  lcd->fb_ye = ye;
+  lcd->dirty_max = 1;
+  ILI9341_RGB565_DECODETOBUF(px, bg)
+  for (uint32_t i=0; i<bytes; i+=2) {
+    strip[i] = px[0];
+    strip[i+1] = px[1];
+  }
+  return ILI9341_SUCCESS;
 }
 
 /**
- * @desc    LCD Update Screen
+ * @desc    Area of a rectangle in pixels
  *
- * @param   void
+ * @param   const ili9341_rect_t* r
  *
- * @return  void
+ * @return  uint32_t
  */
-void ILI9341_UpdateScreen (void)
+static uint32_t rectArea(const ili9341_rect_t *r)
 {
-  // display on
-  ILI9341_TransmitCmmd(ILI9341_DISPON);
+  return (uint32_t) (r->xe - r->xs + 1) * (r->ye - r->ys + 1);
 }
 
 /**
- * @desc    Draw line by Bresenham algoritm
- * @source  https://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm
- *  
- * @param   uint16_t - x start position / 0 <= cols <= ILI9341_SIZE_X
- * @param   uint16_t - x end position   / 0 <= cols <= ILI9341_SIZE_X
- * @param   uint16_t - y start position / 0 <= rows <= ILI9341_SIZE_Y 
- * @param   uint16_t - y end position   / 0 <= rows <= ILI9341_SIZE_Y
- * @param   uint16_t - color
+ * @desc    Smallest rectangle holding two rectangles
  *
- * @return  void
+ * @param   const ili9341_rect_t* a
+ * @param   const ili9341_rect_t* b
+ *
+ * @return  ili9341_rect_t
  */
-void ILI9341_DrawLine(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, uint16_t color)
+static ili9341_rect_t rectUnion(const ili9341_rect_t *a, const ili9341_rect_t *b)
 {
-  // determinant
-  int16_t D;
-  // deltas
-  int16_t delta_x, delta_y;
-  // steps
-  int16_t trace_x = 1, trace_y = 1;
+  ili9341_rect_t u = {
+    .xs = (a->xs < b->xs) ? a->xs : b->xs,
+    .ys = (a->ys < b->ys) ? a->ys : b->ys,
+    .xe = (a->xe > b->xe) ? a->xe : b->xe,
+    .ye = (a->ye > b->ye) ? a->ye : b->ye
+  };
+  return u;
+}
 
-  // delta x
-  delta_x = x2 - x1;
-  // delta y
-  delta_y = y2 - y1;
+/**
+ * @desc    Sets the per-window cost damaged areas are merged by
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t window_cost wire byte times, 0 for the default
+ *
+ * @return  void
+ */
+void ili9341_set_window_cost (ili9341_t *lcd, uint16_t window_cost)
+{
+  lcd->window_cost = window_cost;
+}
 
-  // check if x2 > x1
-  if (delta_x < 0) {
-    // negate delta x
-    delta_x = -delta_x;
-    // negate step x
-    trace_x = -trace_x;
-  }
+/**
+ * @desc    Bus cost of sending an area with a window of its own
+ *
+ * @param   const ili9341_t* lcd
+ * @param   const ili9341_rect_t* r
+ *
+ * @return  int32_t wire byte times
+ */
+static int32_t rectCost(const ili9341_t *lcd, const ili9341_rect_t *r)
+{
+  return (lcd->window_cost ? lcd->window_cost : ILI9341_WINDOW_COST) + (int32_t) rectArea(r)*2;
+}
 
-  // check if y2 > y1
-  if (delta_y < 0) {
-    // negate detla y
-    delta_y = -delta_y;
-    // negate step y
-    trace_y = -trace_y;
+/**
+ * @desc    Cuts off the part of an area a recorded area already covers, where what is left is still a
+ *          rectangle: the recorded area spans all rows of it and one of its ends, or all columns and one
+ *          of its ends
+ *
+ * @param   ili9341_rect_t* a
+ * @param   const ili9341_rect_t* d recorded area
+ *
+ * @return  bool false if nothing of the area is left
+ */
+static bool rectTrim(ili9341_rect_t *a, const ili9341_rect_t *d)
+{
+  if (d->ys <= a->ys && d->ye >= a->ye) {
+    if (d->xs <= a->xs && d->xe >= a->xs) {
+      if (d->xe >= a->xe) {
+        return false;
+      }
+      a->xs = d->xe + 1;
+    } else if (d->xe >= a->xe && d->xs <= a->xe) {
+      a->xe = d->xs - 1;
+    }
+  } else if (d->xs <= a->xs && d->xe >= a->xe) {
+    if (d->ys <= a->ys && d->ye >= a->ys) {
+      a->ys = d->ye + 1;
+    } else if (d->ye >= a->ye && d->ys <= a->ye) {
+      a->ye = d->ys - 1;
+    }
   }
+  return true;
+}
 
-  // Bresenham condition for m < 1 (dy < dx)
-  if (delta_y < delta_x) {
-    // calculate determinant
-    D = (delta_y << 1) - delta_x;
-    // draw first pixel
-    ILI9341_DrawPixel(x1, y1, color);
-    // check if x1 equal x2
-    while (x1 != x2) {
-      // update x1
-      x1 += trace_x;
-      // check if determinant is positive
-      if (D >= 0) {
-        // update y1
-        y1 += trace_y;
-        // update determinant
-        D -= 2*delta_x;    
-      }
-      // update deteminant
-      D += 2*delta_y;
-      // draw next pixel
-      ILI9341_DrawPixel(x1, y1, color);
+/**
+ * @desc    Records a damaged area. The part of it a recorded area covers is cut off, the rest is merged
+ *          with every recorded area whose bounding box together with it costs no more to send than both
+ *          apart. When the list is full the pair of areas (the new one included) whose bounding box adds
+ *          the least cost is merged.
+ *
+ * @param   ili9341_t* lcd
+ * @param   const ili9341_rect_t* r
+ *
+ * @return  void
+ */
+static void dirtyAdd(ili9341_t *lcd, const ili9341_rect_t *r)
+{
+  ili9341_rect_t area = *r;
+  ili9341_rect_t u;
+  int32_t extra, best_extra = INT32_MAX;
+  uint8_t best_i = 0, best_j = 0;
+  uint8_t i = 0;
+
+  // pixels inside a recorded area are sent with it already
+  for (i=0; i<lcd->ndirty; i++) {
+    if (!rectTrim(&area, &lcd->dirty[i])) {
+      return;
     }
-  // for m > 1 (dy > dx)    
-  } else {
-    // calculate determinant
-    D = delta_y - (delta_x << 1);
-    // draw first pixel
-    ILI9341_DrawPixel(x1, y1, color);
-    // check if y2 equal y1
-    while (y1 != y2) {
-      // update y1
-      y1 += trace_y;
-      // check if determinant is positive
-      if (D <= 0) {
-        // update y1
-        x1 += trace_x;
-        // update determinant
-        D += 2*delta_y;    
+  }
+  i = 0;
+  while (i < lcd->ndirty) {
+    u = rectUnion(&area, &lcd->dirty[i]);
+    if (rectCost(lcd, &u) <= rectCost(lcd, &area) + rectCost(lcd, &lcd->dirty[i])) {
+      // take the recorded area out, the union may now swallow others
+      area = u;
+      lcd->dirty[i] = lcd->dirty[--lcd->ndirty];
+      i = 0;
+      continue;
+    }
+    i++;
+  }
+  if (lcd->ndirty < lcd->dirty_max) {
+    lcd->dirty[lcd->ndirty++] = area;
+    return;
+  }
+  for (i=0; i<lcd->ndirty; i++) {
+    for (uint8_t j=i+1; j<=lcd->ndirty; j++) {
+      const ili9341_rect_t *b = (j < lcd->ndirty) ? &lcd->dirty[j] : &area;
+      u = rectUnion(&lcd->dirty[i], b);
+      extra = rectCost(lcd, &u) - rectCost(lcd, &lcd->dirty[i]) - rectCost(lcd, b);
+      if (extra < best_extra) {
+        best_extra = extra;
+        best_i = i;
+        best_j = j;
       }
-      // update deteminant
-      D -= 2*delta_x;
-      // draw next pixel
-      ILI9341_DrawPixel(x1, y1, color);
     }
   }
-  _HW_HOOK(commit, NULL)
+  u = rectUnion(&lcd->dirty[best_i], (best_j < lcd->ndirty) ? &lcd->dirty[best_j] : &area);
+  // the new area takes the slot of a merged one, the merged pair is added again
+  if (best_j < lcd->ndirty) {
+    lcd->dirty[best_j] = area;
+  }
+  lcd->dirty[best_i] = lcd->dirty[--lcd->ndirty];
+  dirtyAdd(lcd, &u);
 }
 
-
 /**
- * @desc    LCD Fast draw line horizontal - depend on MADCTL
+ * @desc    Starts a memory write into the window of the framebuffer, like RAMWR does on the panel
  *
- * @param   uint16_t - xs start position
- * @param   uint16_t - xe end position
- * @param   uint16_t - y position
- * @param   uint16_t - color
+ * @param   ili9341_t* lcd
  *
- * @return  char
+ * @return  void
  */
-char ILI9341_DrawLineHorizontal (uint16_t xs, uint16_t xe, uint16_t y, uint16_t color)
+static void memStart(ili9341_t *lcd)
 {
-  // temp variable
-  uint16_t temp;
-  // check if out of range
-  if ((xs > ILI9341_SIZE_X) || (xe > ILI9341_SIZE_X) || (y > ILI9341_SIZE_Y)) {
-    // error
-    return ILI9341_ERROR;
+  // the framebuffer is about to change, the last flush must have read it
+  if (lcd->fb_inflight) {
+    _HW_HOOK(lcd, barrier, NULL)
+    lcd->fb_inflight = false;
   }
-  // check if start is > as end  
-  if (xs > xe) {
-    // temporary safe
-    temp = xe;
-    // start change for end
-    xe = xs;
-    // end change for start
-    xs = temp;
+  lcd->fb_x = lcd->fb_win.xs;
+  lcd->fb_y = lcd->fb_win.ys;
+  // only the rows the buffer holds are damaged
+  if (lcd->fb_win.ye >= lcd->fb_ys && lcd->fb_win.ys <= lcd->fb_ye) {
+    ili9341_rect_t area = lcd->fb_win;
+    if (area.ys < lcd->fb_ys) {
+      area.ys = lcd->fb_ys;
+    }
+    if (area.ye > lcd->fb_ye) {
+      area.ye = lcd->fb_ye;
+    }
+    dirtyAdd(lcd, &area);
   }
-  // set window
-  ILI9341_SetWindow(xs, y, xe, y);
-  // draw pixel by 565 mode
-  ILI9341_SendColor565(color, xe - xs);
-  _HW_HOOK(commit, NULL)
-  // success
-  return ILI9341_SUCCESS;
 }
 
 /**
- * @desc    LCD Fast draw line vertical - depend on MADCTL
+ * @desc    Copies pixels on the wire into the framebuffer at the write position, which wraps
+ *          inside of the window like the controller address counter
  *
- * @param   uint16_t - x position
- * @param   uint16_t - ys start position
- * @param   uint16_t - ye end position
- * @param   uint16_t - color
+ * @param   ili9341_t* lcd
+ * @param   const uint8_t* bytes
+ * @param   uint32_t len even
  *
- * @return  char
+ * @return  void
  */
-char ILI9341_DrawLineVertical (uint16_t x, uint16_t ys, uint16_t ye, uint16_t color)
+static void memWrite(ili9341_t *lcd, const uint8_t *bytes, uint32_t len)
 {
-  // temp variable
-  uint16_t temp;
-  // check if out of range
-  if ((ys > ILI9341_SIZE_Y) || (ye > ILI9341_SIZE_Y) || (x > ILI9341_SIZE_X)) {
-    // error
-    return ILI9341_ERROR;
-  }  
-  // check if start is > as end
-  if (ys > ye) {
-    // temporary safe
-    temp = ye;
-    // start change for end
-    ye = ys;
-    // end change for start
-    ys = temp;
+  while (len) {
+    uint32_t run = (uint32_t) (lcd->fb_win.xe - lcd->fb_x + 1) * 2;
+    if (run > len) {
+      run = len;
+    }
+    if (lcd->fb_y >= lcd->fb_ys && lcd->fb_y <= lcd->fb_ye) {
+      memcpy(lcd->fb + ((uint32_t) (lcd->fb_y - lcd->fb_ys)*ILI9341_MAX_X + lcd->fb_x)*2, bytes, run);
+    }
+    bytes += run;
+    len -= run;
+    lcd->fb_x += run / 2;
+    // next row of the window, back to the top after the last one
+    if (lcd->fb_x > lcd->fb_win.xe) {
+      lcd->fb_x = lcd->fb_win.xs;
+      lcd->fb_y = (lcd->fb_y >= lcd->fb_win.ye) ? lcd->fb_win.ys : lcd->fb_y + 1;
+    }
   }
-  // set window
-  ILI9341_SetWindow(x, ys, x, ye);
-  // draw pixel by 565 mode
-  ILI9341_SendColor565(color, ye - ys);
-  _HW_HOOK(commit, NULL)
-  // success
-  return ILI9341_SUCCESS;
 }
 
-static void writePx(uint32_t color565) {
-  uint8_t colorBuf[2] = { 0 };
-
-  /* TODO Support 666 color scheme if that's what is enabled */
-  ILI9341_RGB565_DECODETOBUF(colorBuf, color565)
+/**
+ * @desc    Writes count pixels of one color into the framebuffer at the write position
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t color
+ * @param   uint32_t count
+ *
+ * @return  void
+ */
+static void memFill(ili9341_t *lcd, uint16_t color, uint32_t count)
+{
+  uint8_t px[2];
 
-  ILI9341_Transmit8bitData(colorBuf[0]);
-  ILI9341_Transmit8bitData(colorBuf[1]);
+  ILI9341_RGB565_DECODETOBUF(px, color)
+  while (count) {
+    uint32_t run = lcd->fb_win.xe - lcd->fb_x + 1;
+    if (run > count) {
+      run = count;
+    }
+    // rows outside of a strip are dropped
+    if (lcd->fb_y >= lcd->fb_ys && lcd->fb_y <= lcd->fb_ye) {
+      uint8_t *dst = lcd->fb + ((uint32_t) (lcd->fb_y - lcd->fb_ys)*ILI9341_MAX_X + lcd->fb_x)*2;
+      for (uint32_t i=0; i<run; i++) {
+        *dst++ = px[0];
+        *dst++ = px[1];
+      }
+    }
+    count -= run;
+    lcd->fb_x += run;
+    // next row of the window, back to the top after the last one
+    if (lcd->fb_x > lcd->fb_win.xe) {
+      lcd->fb_x = lcd->fb_win.xs;
+      lcd->fb_y = (lcd->fb_y >= lcd->fb_win.ye) ? lcd->fb_win.ys : lcd->fb_y + 1;
+    }
+  }
 }
 
-#define _FONT_BIT(ch, row,col) (FONTS[ch - 32][col] & 1<<row)
-
-char ILI9341_DrawCharFast (char character, uint16_t text_color, uint8_t text_scale, uint16_t bg_color) {
-  // variables
-  uint8_t idxCol, idxRow;
-  // check if character is out of range
-  if ((character < 0x20) &&
-      (character > 0x7f)) {
-    // out of range
-    return 0;
+/**
+ * @desc    Sends an area of the framebuffer with a window and RAMWR of its own
+ *
+ * @param   ili9341_t* lcd
+ * @param   const ili9341_rect_t* r rows held by the framebuffer
+ *
+ * @return  void
+ */
+static void fbSend(ili9341_t *lcd, const ili9341_rect_t *r)
+{
+  uint16_t row = (r->xe - r->xs + 1) * 2;
+  uint8_t *src = lcd->fb + ((uint32_t) (r->ys - lcd->fb_ys)*ILI9341_MAX_X + r->xs)*2;
+
+  busWindow(lcd, r->xs, r->ys, r->xe, r->ye);
+  transmitCmmd(lcd, ILI9341_RAMWR);
+  ili9341_set_data(lcd);
+  if (!_HW_HAS(lcd, sendbuf)) {
+    for (uint16_t y=r->ys; y<=r->ye; y++, src+=ILI9341_MAX_X*2) {
+      for (uint16_t j=0; j<row; j++) {
+        _HW_HOOK(lcd, sendbyte, src[j])
+      }
+    }
+    _HW_HOOK(lcd, commit, NULL)
+    return;
   }
-  // last column of character array - 5 columns
-  idxCol = CHARS_COLS_LENGTH * text_scale;
-  // last row of character array - 8 rows / bits
-  idxRow = CHARS_ROWS_LENGTH * text_scale;
+  // full-width rows are contiguous, send as many at once as a buffer holds
+  uint16_t rows_per_buf = (row == ILI9341_MAX_X*2) ? 65534 / row : 1;
+  for (uint16_t y=r->ys; y<=r->ye; y+=rows_per_buf) {
+    uint16_t rows = (r->ye - y + 1 < rows_per_buf) ? r->ye - y + 1 : rows_per_buf;
+    ili9341_buf_t buf = {.buf=src, .len=rows*row};
+    _HW_HOOK(lcd, sendbuf, &buf)
+    src += (uint32_t) rows*ILI9341_MAX_X*2;
+  }
+  lcd->fb_inflight = true;
+}
 
-  // loop through 5 bits
-  ILI9341_SetWindow(
-    _ili9341_cache_index_col,
-    _ili9341_cache_index_row,
-    _ili9341_cache_index_col + idxCol-1 + text_scale,
-    _ili9341_cache_index_row + idxRow-1);
+/**
+ * @desc    Sends an area of the framebuffer and records it as the frame on the panel
+ *
+ * @param   ili9341_t* lcd
+ * @param   const ili9341_rect_t* r
+ *
+ * @return  void
+ */
+static void diffSend(ili9341_t *lcd, const ili9341_rect_t *r)
+{
+  uint16_t row = (r->xe - r->xs + 1) * 2;
 
-  ILI9341_TransmitCmmd(ILI9341_RAMWR);
+  fbSend(lcd, r);
+  for (uint16_t y=r->ys; y<=r->ye; y++) {
+    memcpy(lcd->prev + ((uint32_t) y*ILI9341_MAX_X + r->xs)*2,
+           lcd->fb + ((uint32_t) (y - lcd->fb_ys)*ILI9341_MAX_X + r->xs)*2, row);
+  }
+}
 
-  ILI9341_SetData();
+/**
+ * @desc    First pixel of a row that differs between two frames, compared two pixels
+ *          (a 32-bit word) at a time
+ *
+ * @param   const uint8_t* a row of the new frame
+ * @param   const uint8_t* b same row of the previous frame
+ * @param   uint16_t x first column
+ * @param   uint16_t xe last column
+ *
+ * @return  uint16_t xe + 1 if the columns are equal
+ */
+static uint16_t diffStart(const uint8_t *a, const uint8_t *b, uint16_t x, uint16_t xe)
+{
+  uint32_t wa, wb;
 
-  for (int i=0; i<idxRow; i++) {
-    for (int j=0; j<idxCol; j++) {
-      bool text_bit = _FONT_BIT(character, i/text_scale, j/text_scale) != 0;
-      writePx(text_bit ? text_color : bg_color);
-    }
-    for (int j=0; j<text_scale; j++) {
-      writePx(bg_color);
+  while (x < xe) {
+    memcpy(&wa, a + x*2, 4);
+    memcpy(&wb, b + x*2, 4);
+    if (wa != wb) {
+      break;
     }
+    x += 2;
   }
-  // update x position
-  _ili9341_cache_index_col += idxCol + text_scale ;
-  _HW_HOOK(commit, NULL)
-  // return exit
-  return ILI9341_SUCCESS;
+  // the differing pair, or the single column left
+  while (x <= xe && a[x*2] == b[x*2] && a[x*2+1] == b[x*2+1]) {
+    x++;
+  }
+  return x;
 }
-#undef _FONT_BIT
 
 /**
- * @desc    Draw character 2x larger
+ * @desc    Last pixel of a run of differing pixels
  *
- * @param   char -> character
- * @param   uint16_t -> color
- * @param   ILI9341_Sizes -> size
+ * @param   const uint8_t* a
+ * @param   const uint8_t* b
+ * @param   uint16_t x differing column the run starts at
+ * @param   uint16_t xe last column
  *
- * @return  void
+ * @return  uint16_t
  */
-char ILI9341_DrawChar (char character, uint16_t color, ILI9341_Sizes size)
+static uint16_t diffEnd(const uint8_t *a, const uint8_t *b, uint16_t x, uint16_t xe)
 {
-  // variables
-  uint8_t letter, idxCol, idxRow;
-  // check if character is out of range
-  if ((character < 0x20) &&
-      (character > 0x7f)) { 
-    // out of range
-    return 0;
+  while (x < xe && (a[x*2+2] != b[x*2+2] || a[x*2+3] != b[x*2+3])) {
+    x++;
   }
-  // last column of character array - 5 columns 
-  idxCol = CHARS_COLS_LENGTH;
-  // last row of character array - 8 rows / bits
-  idxRow = CHARS_ROWS_LENGTH;
+  return x;
+}
 
-  // --------------------------------------
-  // SIZE X1 - normal font 1x high, 1x wide
-  // --------------------------------------
-  if (size == X1) {  
-    // loop through 5 bits
-    while (idxCol--) {
-      // read from ROM memory 
-      letter = FONTS[character - 32][idxCol];
-      // loop through 8 bits
-      while (idxRow--) {
-        // check if bit set
-        if (letter & (1 << idxRow)) {
-          // draw pixel 
-          ILI9341_DrawPixel(_ili9341_cache_index_col + idxCol, _ili9341_cache_index_row + idxRow, color);
-        }
+/**
+ * @desc    Sends the pixels of a damaged area that differ from the previous frame. Changed spans of a row
+ *          are joined over gaps cheaper than a window, a span is joined with the window of the row above
+ *          if widening that window costs less than a new one.
+ *
+ * @param   ili9341_t* lcd
+ * @param   const ili9341_rect_t* r
+ *
+ * @return  void
+ */
+static void diffFlush(ili9341_t *lcd, const ili9341_rect_t *r)
+{
+  int32_t cost = lcd->window_cost ? lcd->window_cost : ILI9341_WINDOW_COST;
+  ili9341_rect_t open = {0, 0, 0, 0};
+  bool is_open = false;
+
+  for (uint16_t y=r->ys; y<=r->ye; y++) {
+    const uint8_t *a = lcd->fb + (uint32_t) (y - lcd->fb_ys)*ILI9341_MAX_X*2;
+    const uint8_t *b = lcd->prev + (uint32_t) y*ILI9341_MAX_X*2;
+    uint16_t xs = diffStart(a, b, r->xs, r->xe);
+
+    while (xs <= r->xe) {
+      uint16_t xe = diffEnd(a, b, xs, r->xe);
+      uint16_t next;
+      // join the following spans while the gap costs less than a window
+      while ((next = diffStart(a, b, xe + 1, r->xe)) <= r->xe && (int32_t) (next - xe - 1)*2 <= cost) {
+        xe = diffEnd(a, b, next, r->xe);
       }
-      // fill index row again
-      idxRow = CHARS_ROWS_LENGTH;
-    }
-    // update x position
-    _ili9341_cache_index_col += CHARS_COLS_LENGTH + 1;
-  
-  // --------------------------------------
-  // SIZE X2 - font 2x higher, normal wide
-  // --------------------------------------
-  } else if (size == X2) {
-    // loop through 5 bytes
-    while (idxCol--) {
-      // read from ROM memory 
-      letter = FONTS[character - 32][idxCol];
-      // loop through 8 bits
-      while (idxRow--) {
-        // check if bit set
-        if (letter & (1 << idxRow)) {
-          // draw first left up pixel; 
-          // (idxRow << 1) - 2x multiplied 
-          ILI9341_DrawPixel(_ili9341_cache_index_col + idxCol, _ili9341_cache_index_row + (idxRow << 1), color);
-          // draw second left down pixel
-          ILI9341_DrawPixel(_ili9341_cache_index_col + idxCol, _ili9341_cache_index_row + (idxRow << 1) + 1, color);
+      if (is_open && open.ye == y - 1) {
+        uint16_t us = (xs < open.xs) ? xs : open.xs;
+        uint16_t ue = (xe > open.xe) ? xe : open.xe;
+        int32_t widen = ((int32_t) (ue - us - open.xe + open.xs)*(open.ye - open.ys + 1) + (ue - us - xe + xs))*2;
+        if (widen <= cost) {
+          open.xs = us;
+          open.xe = ue;
+          open.ye = y;
+          xs = next;
+          continue;
         }
       }
-      // fill index row again
-      idxRow = CHARS_ROWS_LENGTH;
+      if (is_open) {
+        diffSend(lcd, &open);
+      }
+      open.xs = xs;
+      open.xe = xe;
+      open.ys = open.ye = y;
+      is_open = true;
+      xs = next;
     }
-    // update x position
-    _ili9341_cache_index_col += CHARS_COLS_LENGTH + 2;
+  }
+  if (is_open) {
+    diffSend(lcd, &open);
+  }
+}
 
-  // --------------------------------------
-  // SIZE X3 - font 2x higher, 2x wider
-  // --------------------------------------
-  } else if (size == X3) {
-    // loop through 5 bytes
-    while (idxCol--) {
-      // read from ROM memory 
-      letter = FONTS[character - 32][idxCol];
-      // loop through 8 bits
-      while (idxRow--) {
-        // check if bit set
-        if (letter & (1 << idxRow)) {
-          // draw first left up pixel; 
-          // (idxRow << 1) - 2x multiplied 
-          ILI9341_DrawPixel(_ili9341_cache_index_col + (idxCol << 1), _ili9341_cache_index_row + (idxRow << 1), color);
-          // draw second left down pixel
-          ILI9341_DrawPixel(_ili9341_cache_index_col + (idxCol << 1), _ili9341_cache_index_row + (idxRow << 1) + 1, color);
-          // draw third right up pixel
-          ILI9341_DrawPixel(_ili9341_cache_index_col + (idxCol << 1) + 1, _ili9341_cache_index_row + (idxRow << 1), color);
-          // draw fourth right down pixel
-          ILI9341_DrawPixel(_ili9341_cache_index_col + (idxCol << 1) + 1, _ili9341_cache_index_row + (idxRow << 1) + 1, color);
-        }
-      }
-      // fill index row again
-      idxRow = CHARS_ROWS_LENGTH;
+/**
+ * @desc    Sends the damaged areas of the framebuffer
+ *
+ * @param   ili9341_t* lcd
+ *
+ * @return  void
+ */
+void ili9341_flush (ili9341_t *lcd)
+{
+  if (lcd->fb == NULL) {
+    return;
+  }
+  for (uint8_t i=0; i<lcd->ndirty; i++) {
+    if (lcd->prev) {
+      diffFlush(lcd, &lcd->dirty[i]);
+    } else {
+      fbSend(lcd, &lcd->dirty[i]);
     }
-    // update x position *2
-    _ili9341_cache_index_col += (CHARS_COLS_LENGTH << 1) + 2;
   }
-  _HW_HOOK(commit, NULL)
-  // return exit
-  return ILI9341_SUCCESS;
+  lcd->ndirty = 0;
 }
 
-
-void ILI9341_DrawStringFast (char *str, uint16_t text_color, uint8_t size, uint16_t bg_color)
+/**
+ * @desc    Sets the copy of the frame on the panel flushes are compared against
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint8_t* prev ILI9341_FB_SIZE bytes, NULL to send damaged areas whole
+ *
+ * @return  void
+ */
+void ili9341_attach_prev_frame (ili9341_t *lcd, uint8_t *prev)
 {
-  // variables
-  unsigned int i = 0;
-  char check;
-  uint16_t delta_y;
-  uint16_t max_y_pos;
-  uint16_t new_x_pos;
-  uint16_t new_y_pos;
+  lcd->prev = prev;
+}
+#endif
 
-  // loop through character of string
-  while (str[i] != '\0') {
-    // max x position character
-    new_x_pos = _ili9341_cache_index_col + CHARS_COLS_LENGTH*size;
-    // delta y
-    delta_y = CHARS_ROWS_LENGTH*size;
-    // max y position character
-    new_y_pos = _ili9341_cache_index_row + delta_y;
-    // max y pos
-    max_y_pos = ILI9341_SIZE_Y - delta_y;
-    // control if will be in range
-    check = ILI9341_CheckPosition(new_x_pos, new_y_pos, max_y_pos, size);
-    // update position
-    if (ILI9341_SUCCESS == check) {
-      // read characters and increment index
-      ILI9341_DrawCharFast(str[i++], text_color, size, bg_color);
-    }
+/**
+ * @desc    LCD Inverse Screen
+ *
+ * @param   ili9341_t* lcd
+ *
+ * @return  void
+ */
+void ili9341_inverse_screen (ili9341_t *lcd)
+{
+  // already inverted
+  if ((lcd->shadow.valid & _SHADOW_INVERSION) && lcd->shadow.inverted) {
+    return;
   }
+  shadowUpdate(lcd, ILI9341_DINVON, NULL, 0);
+  // display on
+  transmitCmmd(lcd, ILI9341_DINVON);
 }
 
 /**
- * @desc    Draw string
+ * @desc    LCD Normal Screen
  *
- * @param   char* -> string 
- * @param   uint16_t -> color
- * @param   ILI9341_Sizes -> size
+ * @param   ili9341_t* lcd
  *
  * @return  void
  */
-void ILI9341_DrawString (char *str, uint16_t color, ILI9341_Sizes size)
+void ili9341_normal_screen (ili9341_t *lcd)
 {
-  // variables
-  unsigned int i = 0;
-  char check;
-  uint16_t delta_y;
-  uint16_t max_y_pos;
-  uint16_t new_x_pos;
-  uint16_t new_y_pos;
+  // already normal
+  if ((lcd->shadow.valid & _SHADOW_INVERSION) && !lcd->shadow.inverted) {
+    return;
+  }
+  shadowUpdate(lcd, ILI9341_DINVOFF, NULL, 0);
+  // display on
+  transmitCmmd(lcd, ILI9341_DINVOFF);
+}
 
-  // loop through character of string
-  while (str[i] != '\0') {
-    // max x position character
-    new_x_pos = _ili9341_cache_index_col + CHARS_COLS_LENGTH + (size & 0x0F);
-    // delta y
-    delta_y = CHARS_ROWS_LENGTH + (size >> 4);
-    // max y position character
-    new_y_pos = _ili9341_cache_index_row + delta_y;
-    // max y pos
-    max_y_pos = ILI9341_SIZE_Y - delta_y;
-    // control if will be in range
-    check = ILI9341_CheckPosition(new_x_pos, new_y_pos, max_y_pos, size);
-    // update position
-    if (ILI9341_SUCCESS == check) {
-      // read characters and increment index
-      ILI9341_DrawChar(str[i++], color, size);
-    }
+/**
+ * @desc    LCD Memory Access Control, skipped if the controller already holds the value
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint8_t madctl
+ *
+ * @return  void
+ */
+void ili9341_set_memory_access (ili9341_t *lcd, uint8_t madctl)
+{
+  if ((lcd->shadow.valid & _SHADOW_MADCTL) && (lcd->shadow.madctl == madctl)) {
+    return;
   }
+  shadowUpdate(lcd, ILI9341_MADCTL, &madctl, 1);
+  transmitCmmd(lcd, ILI9341_MADCTL);
+  ili9341_set_data(lcd);
+  ili9341_transmit_8bit_data(lcd, madctl);
+  _HW_HOOK(lcd, commit, NULL)
 }
 
 /**
- * @desc    Check text position x, y
+ * @desc    LCD Pixel Format Set, skipped if the controller already holds the value
  *
- * @param   uint16_t
- * @param   uint16_t
- * @param   uint16_t
- * @param   ILI9341_Sizes
+ * @param   ili9341_t* lcd
+ * @param   uint8_t colmod
  *
- * @return  char
+ * @return  void
  */
-char ILI9341_CheckPosition (uint16_t x, uint16_t y, uint16_t max_y, ILI9341_Sizes size)
+void ili9341_set_pixel_format (ili9341_t *lcd, uint8_t colmod)
 {
-  /* TODO What is this params purpose? */
-  (void) size;
-  // check if coordinates is out of range
-  if ((x > ILI9341_SIZE_X) && (y > max_y)) {  
-    // error
-    return ILI9341_ERROR;
+  if ((lcd->shadow.valid & _SHADOW_COLMOD) && (lcd->shadow.colmod == colmod)) {
+    return;
   }
-  // if next line
-  if ((x > ILI9341_SIZE_X) && (y <= max_y)) {
-    // set position y
-    _ili9341_cache_index_row = y;
-    // set position x
-    _ili9341_cache_index_col = 2;
-  } 
-  // return exit
-  return ILI9341_SUCCESS;
+  shadowUpdate(lcd, ILI9341_COLMOD, &colmod, 1);
+  transmitCmmd(lcd, ILI9341_COLMOD);
+  ili9341_set_data(lcd);
+  ili9341_transmit_8bit_data(lcd, colmod);
+  _HW_HOOK(lcd, commit, NULL)
 }
 
 /**
- * @desc    LCD Set text position x, y
+ * @desc    Sends the scroll position
  *
- * @param   uint16_t x - position
- * @param   uint16_t y - position
+ * @param   ili9341_t* lcd
+ *
+ * @return  void
+ */
+static void scrollStart(ili9341_t *lcd)
+{
+  transmitCmmd(lcd, ILI9341_VSSAD);
+  ili9341_set_data(lcd);
+  ili9341_transmit_16bit_data(lcd, lcd->scroll.tfa + lcd->scroll.off);
+  _HW_HOOK(lcd, commit, NULL)
+}
+
+/**
+ * @desc    LCD Vertical Scroll Definition, resets the scroll position
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t top fixed rows
+ * @param   uint16_t bottom fixed rows
  *
  * @return  char
  */
-char ILI9341_SetPosition (uint16_t x, uint16_t y)
+char ili9341_set_scroll_area (ili9341_t *lcd, uint16_t top, uint16_t bottom)
 {
-  // check if coordinates is out of range
-  if ((x > ILI9341_SIZE_X) && (y > ILI9341_SIZE_Y)) {
-    // error
+  if ((uint32_t) top + bottom >= ILI9341_MAX_Y) {
     return ILI9341_ERROR;
-  // x overflow, y in range
-  } else if ((x > ILI9341_SIZE_X) && (y <= ILI9341_SIZE_Y)) {
-    // set position y
-    _ili9341_cache_index_row = y;
-    // set position x
-    _ili9341_cache_index_col = 2;
-  } else {
-    // set position y 
-    _ili9341_cache_index_row = y;
-    // set position x
-    _ili9341_cache_index_col = x;
   }
-  // return exit
+  lcd->scroll.tfa = top;
+  lcd->scroll.vsa = ILI9341_MAX_Y - top - bottom;
+  lcd->scroll.off = 0;
+  transmitCmmd(lcd, ILI9341_VSCRDEF);
+  ili9341_set_data(lcd);
+  ili9341_transmit_16bit_data(lcd, top);
+  ili9341_transmit_16bit_data(lcd, lcd->scroll.vsa);
+  ili9341_transmit_16bit_data(lcd, bottom);
+  _HW_HOOK(lcd, commit, NULL)
+  scrollStart(lcd);
+
   return ILI9341_SUCCESS;
 }
 
-static bool _get_bit_from_src_rowmajor(const uint8_t* src, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-#define BITN(x,y) (w*y+x)
-  return (src[BITN(x,y)/8] & ((0x1<<(BITN(x,y)) % 8))) != 0;
-#undef BITN
+/**
+ * @desc    LCD Vertical Scrolling Start Address, moved by a number of lines
+ *
+ * @param   ili9341_t* lcd
+ * @param   int16_t lines up if positive
+ *
+ * @return  void
+ */
+void ili9341_scroll (ili9341_t *lcd, int16_t lines)
+{
+  int32_t off;
+
+  // the panel scrolls the whole screen until an area is defined
+  if (!lcd->scroll.vsa) {
+    lcd->scroll.tfa = 0;
+    lcd->scroll.vsa = ILI9341_MAX_Y;
+  }
+  off = ((int32_t) lcd->scroll.off + lines) % lcd->scroll.vsa;
+  lcd->scroll.off = (off < 0) ? off + lcd->scroll.vsa : off;
+  scrollStart(lcd);
 }
 
-static bool _get_bit_from_src_colmajor(const uint8_t* src, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-#define BITN(x,y) (h*x+y)
-  return (src[BITN(x,y)/8] & ((0x1<<(BITN(x,y)) % 8))) != 0;
-#undef BITN
+/**
+ * @desc    LCD Update Screen
+ *
+ * @param   ili9341_t* lcd
+ *
+ * @return  void
+ */
+void ili9341_update_screen (ili9341_t *lcd)
+{
+  // display on
+  transmitCmmd(lcd, ILI9341_DISPON);
 }
 
-static void _RenderScaledBitmap(uint8_t* dst, uint16_t dst_w, uint16_t dst_h, const uint8_t* src, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565, bool (*getbit)(const uint8_t* buf, uint16_t x, uint16_t y, uint16_t w, uint16_t h)) {
-  /* Zero out the dst buffer */
-  for (int i=0; i<dst_h; i++) {
-    for (int j=0; j<dst_w; j++) {
-      uint16_t src_x = (j*src_w)/dst_w;
-      uint16_t src_y = (i*src_h)/dst_h;
-      uint8_t* render_out_offset = dst+(i*dst_w+j)*2;
-      if (getbit(src, src_x, src_y, src_w, src_h)) {
-        ILI9341_RGB565_DECODETOBUF(render_out_offset, fg565);
-      } else {
-        ILI9341_RGB565_DECODETOBUF(render_out_offset, bg565);
-      }
-    }
+/**
+ * @desc    Draws a horizontal (ys == ye) or vertical (xs == xe) run of pixels with a
+ *          single window and RAMWR burst. Ends may come in any order, the part of the
+ *          run outside of the screen is clipped.
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t xs
+ * @param   uint16_t ys
+ * @param   uint16_t xe
+ * @param   uint16_t ye
+ * @param   uint16_t color
+ *
+ * @return  void
+ */
+static void drawSpan(ili9341_t *lcd, uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye, uint16_t color)
+{
+  uint16_t temp;
+
+  if (xs > xe) {
+    temp = xs; xs = xe; xe = temp;
+  }
+  if (ys > ye) {
+    temp = ys; ys = ye; ye = temp;
+  }
+  // clip
+  if ((xs > ILI9341_SIZE_X) || (ys > ILI9341_SIZE_Y)) {
+    return;
+  }
+  if (xe > ILI9341_SIZE_X) {
+    xe = ILI9341_SIZE_X;
   }
+  if (ye > ILI9341_SIZE_Y) {
+    ye = ILI9341_SIZE_Y;
+  }
+  ili9341_set_window(lcd, xs, ys, xe, ye);
+  ili9341_send_color565(lcd, color, (uint32_t) (xe - xs + 1) * (ye - ys + 1));
 }
 
-void ILI9341_RenderScaledBitmap(uint8_t* dst, uint16_t dst_w, uint16_t dst_h, const uint8_t* src, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565) {
-  _RenderScaledBitmap(dst, dst_w, dst_h, src, src_w, src_h, fg565, bg565, _get_bit_from_src_rowmajor);
-}
+/**
+ * @desc    Draw line by Bresenham algoritm
+ *          Pixels are grouped into maximal horizontal (m < 1) or vertical (m >= 1) runs,
+ *          each run costs one window and one RAMWR burst.
+ * @source  https://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm
+ *  
+ * @param   ili9341_t* lcd
+ * @param   uint16_t - x start position / 0 <= cols <= ILI9341_SIZE_X
+ * @param   uint16_t - x end position   / 0 <= cols <= ILI9341_SIZE_X
+ * @param   uint16_t - y start position / 0 <= rows <= ILI9341_SIZE_Y 
+ * @param   uint16_t - y end position   / 0 <= rows <= ILI9341_SIZE_Y
+ * @param   uint16_t - color
+ *
+ * @return  void
+ */
+void ili9341_draw_line(ili9341_t *lcd, uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, uint16_t color)
+{
+  // determinant
+  int16_t D;
+  // deltas
+  int16_t delta_x, delta_y;
+  // steps
+  int16_t trace_x = 1, trace_y = 1;
+  // start of the current run
+  uint16_t run;
 
-void ILI9341_RenderScaledBitmapColMajor(uint8_t* dst, uint16_t dst_w, uint16_t dst_h, const uint8_t* src, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565) {
-  _RenderScaledBitmap(dst, dst_w, dst_h, src, src_w, src_h, fg565, bg565, _get_bit_from_src_colmajor);
-}
+  // delta x
+  delta_x = x2 - x1;
+  // delta y
+  delta_y = y2 - y1;
 
-void ILI9341_RenderBitmap(uint8_t* render_out, const uint8_t* bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565) {
-  ILI9341_RenderScaledBitmap(render_out, w, h, bitmap, w, h, fg565, bg565);
-}
+  // check if x2 > x1
+  if (delta_x < 0) {
+    // negate delta x
+    delta_x = -delta_x;
+    // negate step x
+    trace_x = -trace_x;
+  }
 
-void ILI9341_RenderBitmapColMajor(uint8_t* render_out, const uint8_t* bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565) {
-  ILI9341_RenderScaledBitmapColMajor(render_out, w, h, bitmap, w, h, fg565, bg565);
+  // check if y2 > y1
+  if (delta_y < 0) {
+    // negate detla y
+    delta_y = -delta_y;
+    // negate step y
+    trace_y = -trace_y;
+  }
+
+  // Bresenham condition for m < 1 (dy < dx)
+  if (delta_y < delta_x) {
+    // calculate determinant
+    D = (delta_y << 1) - delta_x;
+    // first pixel of the current horizontal run
+    run = x1;
+    // check if x1 equal x2
+    while (x1 != x2) {
+      // check if determinant is positive
+      if (D >= 0) {
+        // row changes, draw the run up to the current pixel
+        drawSpan(lcd, run, y1, x1, y1, color);
+        // update y1
+        y1 += trace_y;
+        // next run starts at the next pixel
+        run = x1 + trace_x;
+        // update determinant
+        D -= 2*delta_x;    
+      }
+      // update x1
+      x1 += trace_x;
+      // update deteminant
+      D += 2*delta_y;
+    }
+    // draw last run
+    drawSpan(lcd, run, y1, x1, y1, color);
+  // for m > 1 (dy > dx)    
+  } else {
+    // calculate determinant
+    D = delta_y - (delta_x << 1);
+    // first pixel of the current vertical run
+    run = y1;
+    // check if y2 equal y1
+    while (y1 != y2) {
+      // check if determinant is positive
+      if (D <= 0) {
+        // column changes, draw the run up to the current pixel
+        drawSpan(lcd, x1, run, x1, y1, color);
+        // update x1
+        x1 += trace_x;
+        // next run starts at the next pixel
+        run = y1 + trace_y;
+        // update determinant
+        D += 2*delta_y;    
+      }
+      // update y1
+      y1 += trace_y;
+      // update deteminant
+      D -= 2*delta_x;
+    }
+    // draw last run
+    drawSpan(lcd, x1, run, x1, y1, color);
+  }
+  _HW_HOOK(lcd, commit, NULL)
+}
+
+
+/**
+ * @desc    LCD Fast draw line horizontal - depend on MADCTL
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t - xs start position
+ * @param   uint16_t - xe end position
+ * @param   uint16_t - y position
+ * @param   uint16_t - color
+ *
+ * @return  char
+ */
+char ili9341_draw_line_horizontal (ili9341_t *lcd, uint16_t xs, uint16_t xe, uint16_t y, uint16_t color)
+{
+  // temp variable
+  uint16_t temp;
+  // check if out of range
+  if ((xs > ILI9341_SIZE_X) || (xe > ILI9341_SIZE_X) || (y > ILI9341_SIZE_Y)) {
+    // error
+    return ILI9341_ERROR;
+  }
+  // check if start is > as end  
+  if (xs > xe) {
+    // temporary safe
+    temp = xe;
+    // start change for end
+    xe = xs;
+    // end change for start
+    xs = temp;
+  }
+  // set window
+  ili9341_set_window(lcd, xs, y, xe, y);
+  // draw pixel by 565 mode
+  ili9341_send_color565(lcd, color, xe - xs);
+  _HW_HOOK(lcd, commit, NULL)
+  // success
+  return ILI9341_SUCCESS;
+}
+
+/**
+ * @desc    LCD Fast draw line vertical - depend on MADCTL
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t - x position
+ * @param   uint16_t - ys start position
+ * @param   uint16_t - ye end position
+ * @param   uint16_t - color
+ *
+ * @return  char
+ */
+char ili9341_draw_line_vertical (ili9341_t *lcd, uint16_t x, uint16_t ys, uint16_t ye, uint16_t color)
+{
+  // temp variable
+  uint16_t temp;
+  // check if out of range
+  if ((ys > ILI9341_SIZE_Y) || (ye > ILI9341_SIZE_Y) || (x > ILI9341_SIZE_X)) {
+    // error
+    return ILI9341_ERROR;
+  }  
+  // check if start is > as end
+  if (ys > ye) {
+    // temporary safe
+    temp = ye;
+    // start change for end
+    ye = ys;
+    // end change for start
+    ys = temp;
+  }
+  // set window
+  ili9341_set_window(lcd, x, ys, x, ye);
+  // draw pixel by 565 mode
+  ili9341_send_color565(lcd, color, ye - ys);
+  _HW_HOOK(lcd, commit, NULL)
+  // success
+  return ILI9341_SUCCESS;
+}
+
+static void writePx(ili9341_t *lcd, uint32_t color565) {
+  uint8_t colorBuf[2] = { 0 };
+
+  /* TODO Support 666 color scheme if that's what is enabled */
+  ILI9341_RGB565_DECODETOBUF(colorBuf, color565)
+
+  ili9341_transmit_8bit_data(lcd, colorBuf[0]);
+  ili9341_transmit_8bit_data(lcd, colorBuf[1]);
+}
+
+uint32_t ili9341_utf8_next (const char **str)
+{
+  const uint8_t *s = (const uint8_t *) *str;
+  uint32_t cp;
+  uint8_t n;
+
+  if (s[0] < 0x80) {
+    // stays at the terminating '\0'
+    *str += (s[0] != '\0');
+    return s[0];
+  }
+  // lead byte, continuation bytes following
+  if (s[0] >= 0xc2 && s[0] <= 0xdf) {
+    n = 1;
+    cp = s[0] & 0x1f;
+  } else if ((s[0] & 0xf0) == 0xe0) {
+    n = 2;
+    cp = s[0] & 0x0f;
+  } else if (s[0] >= 0xf0 && s[0] <= 0xf4) {
+    n = 3;
+    cp = s[0] & 0x07;
+  } else {
+    (*str)++;
+    return ILI9341_UTF8_INVALID;
+  }
+  for (uint8_t i = 1; i <= n; i++) {
+    // a '\0' ends the sequence here as well
+    if ((s[i] & 0xc0) != 0x80) {
+      (*str)++;
+      return ILI9341_UTF8_INVALID;
+    }
+    cp = (cp << 6) | (s[i] & 0x3f);
+  }
+  // overlong, surrogate or beyond U+10FFFF
+  if ((n == 2 && cp < 0x800) || (cp >= 0xd800 && cp <= 0xdfff) || (n == 3 && (cp < 0x10000 || cp > 0x10ffff))) {
+    (*str)++;
+    return ILI9341_UTF8_INVALID;
+  }
+  *str += n + 1;
+  return cp;
+}
+
+/**
+ * @desc    Tells if the built-in font has a character, 0x20 to 0x7f
+ *
+ * @param   char character
+ *
+ * @return  bool
+ */
+static bool fontHas(char character)
+{
+  return (uint8_t) character >= 0x20 && (uint8_t) character <= 0x7f;
+}
+
+/** @struct State of a run of character cells being streamed */
+typedef struct {
+  const char *str;        // characters of the run
+  uint8_t scale;
+  uint16_t cols;          // visible columns of the run
+  uint16_t row, col;      // next pixel
+  uint8_t rowbit;         // font bit of the row
+  uint8_t cell, cx, sx;   // character, column in the cell, column in the scaled font column
+  uint8_t fg[2], bg[2];   // colors on the wire
+} text_stream_t;
+
+/**
+ * @desc    Renders the pixels of a run of character cells: the scaled glyphs, each followed by a
+ *          spacing column of background, row by row across the whole run
+ *
+ * @param   void* arg text_stream_t
+ * @param   uint8_t* buf
+ * @param   uint16_t len
+ *
+ * @return  void
+ */
+static void renderText(void *arg, uint8_t *buf, uint16_t len)
+{
+  text_stream_t *ts = arg;
+
+  for (uint16_t i=0; i<len; i+=2) {
+    // the spacing column past the font data is background
+    bool text_bit = (ts->cx < CHARS_COLS_LENGTH) && (FONTS[ts->str[ts->cell] - 32][ts->cx] & ts->rowbit);
+    const uint8_t *px = text_bit ? ts->fg : ts->bg;
+    buf[i] = px[0];
+    buf[i+1] = px[1];
+    if (++ts->sx == ts->scale) {
+      ts->sx = 0;
+      if (++ts->cx == CHARS_COLS_LENGTH + 1) {
+        ts->cx = 0;
+        ts->cell++;
+      }
+    }
+    if (++ts->col == ts->cols) {
+      ts->col = 0;
+      ts->cell = 0;
+      ts->cx = 0;
+      ts->sx = 0;
+      ts->rowbit = 1 << (++ts->row / ts->scale);
+    }
+  }
+}
+
+/**
+ * @desc    Draws a run of characters on one text line at the cursor with a single window and RAMWR,
+ *          cells crossing the right or bottom edge are clipped. Moves the cursor past the run.
+ *
+ * @param   ili9341_t* lcd
+ * @param   const char* str
+ * @param   uint16_t n characters
+ * @param   uint16_t text_color
+ * @param   uint8_t text_scale
+ * @param   uint16_t bg_color
+ *
+ * @return  void
+ */
+static void streamText(ili9341_t *lcd, const char *str, uint16_t n, uint16_t text_color, uint8_t text_scale, uint16_t bg_color)
+{
+  // run width, cells of 5 columns and one spacing column
+  uint16_t w = (CHARS_COLS_LENGTH + 1) * text_scale * n;
+  // cell height, 8 rows / bits
+  uint16_t h = CHARS_ROWS_LENGTH * text_scale;
+  text_stream_t ts;
+
+  ts.str = str;
+  ts.scale = text_scale;
+  ts.row = 0;
+  ts.col = 0;
+  ts.rowbit = 1;
+  ts.cell = 0;
+  ts.cx = 0;
+  ts.sx = 0;
+  ts.cols = (lcd->cache_index_col + w > ILI9341_MAX_X) ? ILI9341_MAX_X - lcd->cache_index_col : w;
+  ILI9341_RGB565_DECODETOBUF(ts.fg, text_color)
+  ILI9341_RGB565_DECODETOBUF(ts.bg, bg_color)
+
+  ili9341_stream_rect(lcd,
+    lcd->cache_index_col,
+    lcd->cache_index_row,
+    ts.cols,
+    (lcd->cache_index_row + h > ILI9341_MAX_Y) ? ILI9341_MAX_Y - lcd->cache_index_row : h,
+    renderText, &ts);
+
+  // update x position
+  lcd->cache_index_col += w;
+}
+
+char ili9341_attach_glyph_cache (ili9341_t *lcd, uint8_t *pool, uint32_t len, uint8_t max_scale)
+{
+  // a cell has to fit the uint16_t offsets of renderGlyphs
+  uint32_t slots = (max_scale && max_scale <= 26) ? len / ILI9341_GLYPH_SLOT_SIZE(max_scale) : 0;
+
+  lcd->glyphs.pool = NULL;
+  lcd->glyphs.hits = 0;
+  lcd->glyphs.misses = 0;
+  if (!pool) {
+    return ILI9341_SUCCESS;
+  }
+  if (!slots) {
+    return ILI9341_ERROR;
+  }
+  lcd->glyphs.slots = (slots > UINT16_MAX) ? UINT16_MAX : slots;
+  lcd->glyphs.slot_len = ILI9341_GLYPH_SLOT_SIZE(max_scale);
+  lcd->glyphs.max_scale = max_scale;
+  lcd->glyphs.clock = 0;
+  for (uint16_t i=0; i<lcd->glyphs.slots; i++) {
+    ((ili9341_glyph_t *) (pool + (uint32_t) i * lcd->glyphs.slot_len))->used = 0;
+  }
+  lcd->glyphs.pool = pool;
+
+  return ILI9341_SUCCESS;
+}
+
+void ili9341_glyph_cache_stats (const ili9341_t *lcd, uint32_t *hits, uint32_t *misses)
+{
+  *hits = lcd->glyphs.hits;
+  *misses = lcd->glyphs.misses;
+}
+
+/**
+ * @desc    Finds the rendered cell of a character in the glyph cache, rendering it into the least
+ *          recently used slot if it is not there
+ *
+ * @param   ili9341_t* lcd
+ * @param   char character
+ * @param   uint16_t text_color
+ * @param   uint8_t text_scale
+ * @param   uint16_t bg_color
+ *
+ * @return  uint8_t* pixels of the cell as they go on the wire
+ */
+static uint8_t *glyphFind(ili9341_t *lcd, char character, uint16_t text_color, uint8_t text_scale, uint16_t bg_color)
+{
+  ili9341_glyph_t *slot, *lru = NULL;
+  text_stream_t ts;
+
+  for (uint16_t i=0; i<lcd->glyphs.slots; i++) {
+    slot = (ili9341_glyph_t *) (lcd->glyphs.pool + (uint32_t) i * lcd->glyphs.slot_len);
+    if (slot->used && slot->character == character && slot->scale == text_scale &&
+        slot->fg == text_color && slot->bg == bg_color) {
+      slot->used = ++lcd->glyphs.clock;
+      lcd->glyphs.hits++;
+      return (uint8_t *) (slot + 1);
+    }
+    if (!lru || slot->used < lru->used) {
+      lru = slot;
+    }
+  }
+  lcd->glyphs.misses++;
+  lru->used = ++lcd->glyphs.clock;
+  lru->character = character;
+  lru->scale = text_scale;
+  lru->fg = text_color;
+  lru->bg = bg_color;
+
+  ts.str = &character;
+  ts.scale = text_scale;
+  ts.row = 0;
+  ts.col = 0;
+  ts.rowbit = 1;
+  ts.cell = 0;
+  ts.cx = 0;
+  ts.sx = 0;
+  ts.cols = (CHARS_COLS_LENGTH + 1) * text_scale;
+  ILI9341_RGB565_DECODETOBUF(ts.fg, text_color)
+  ILI9341_RGB565_DECODETOBUF(ts.bg, bg_color)
+  renderText(&ts, (uint8_t *) (lru + 1), ts.cols * CHARS_ROWS_LENGTH * text_scale * 2);
+
+  return (uint8_t *) (lru + 1);
+}
+
+/** @struct State of a run of cached character cells being streamed */
+typedef struct {
+  const uint8_t *cells[ILI9341_GLYPH_RUN];  // pixels of the cells in the cache
+  uint16_t cell_len;      // bytes of a cell row
+  uint16_t cols;          // visible bytes of a run row
+  uint16_t col;           // next byte of the run row
+  uint16_t row_off;       // offset of the row in a cell
+  uint16_t cell;          // cell of the next byte
+  uint16_t off;           // offset of the next byte in the cell row
+} glyph_stream_t;
+
+/**
+ * @desc    Renders the pixels of a run of cached character cells, copying every row of a cell out of
+ *          its slot, row by row across the whole run
+ *
+ * @param   void* arg glyph_stream_t
+ * @param   uint8_t* buf
+ * @param   uint16_t len
+ *
+ * @return  void
+ */
+static void renderGlyphs(void *arg, uint8_t *buf, uint16_t len)
+{
+  glyph_stream_t *gs = arg;
+  uint16_t part;
+
+  while (len) {
+    // up to the end of the cell row, the run row or the buffer
+    part = gs->cell_len - gs->off;
+    if (part > gs->cols - gs->col) {
+      part = gs->cols - gs->col;
+    }
+    if (part > len) {
+      part = len;
+    }
+    memcpy(buf, gs->cells[gs->cell] + gs->row_off + gs->off, part);
+    buf += part;
+    len -= part;
+    gs->col += part;
+    gs->off += part;
+    if (gs->col == gs->cols) {
+      gs->col = 0;
+      gs->cell = 0;
+      gs->off = 0;
+      gs->row_off += gs->cell_len;
+    } else if (gs->off == gs->cell_len) {
+      gs->off = 0;
+      gs->cell++;
+    }
+  }
+}
+
+/**
+ * @desc    Draws a run of characters on one text line at the cursor. With a glyph cache attached, the
+ *          cells are looked up in it and their rows streamed out of it with a single window per run of
+ *          ILI9341_GLYPH_RUN cells, otherwise they are rendered.
+ *
+ * @param   ili9341_t* lcd
+ * @param   const char* str
+ * @param   uint16_t n characters
+ * @param   uint16_t text_color
+ * @param   uint8_t text_scale
+ * @param   uint16_t bg_color
+ *
+ * @return  void
+ */
+static void drawText(ili9341_t *lcd, const char *str, uint16_t n, uint16_t text_color, uint8_t text_scale, uint16_t bg_color)
+{
+  uint16_t w = (CHARS_COLS_LENGTH + 1) * text_scale;
+  uint16_t h = CHARS_ROWS_LENGTH * text_scale;
+  // a run never looks up more cells than there are slots, so none of them evicts another
+  uint16_t run = (lcd->glyphs.slots < ILI9341_GLYPH_RUN) ? lcd->glyphs.slots : ILI9341_GLYPH_RUN;
+  uint16_t cells;
+  glyph_stream_t gs;
+
+  if (!lcd->glyphs.pool || text_scale > lcd->glyphs.max_scale) {
+    streamText(lcd, str, n, text_color, text_scale, bg_color);
+    return;
+  }
+  while (n && lcd->cache_index_col < ILI9341_MAX_X) {
+    cells = (n < run) ? n : run;
+    for (uint16_t i=0; i<cells; i++) {
+      gs.cells[i] = glyphFind(lcd, str[i], text_color, text_scale, bg_color);
+    }
+    gs.cell_len = w*2;
+    gs.cols = (lcd->cache_index_col + cells*w > ILI9341_MAX_X) ? ILI9341_MAX_X - lcd->cache_index_col : cells*w;
+    gs.cols *= 2;
+    gs.col = 0;
+    gs.row_off = 0;
+    gs.cell = 0;
+    gs.off = 0;
+    ili9341_stream_rect(lcd,
+      lcd->cache_index_col,
+      lcd->cache_index_row,
+      gs.cols / 2,
+      (lcd->cache_index_row + h > ILI9341_MAX_Y) ? ILI9341_MAX_Y - lcd->cache_index_row : h,
+      renderGlyphs, &gs);
+    lcd->cache_index_col += cells*w;
+    str += cells;
+    n -= cells;
+  }
+  // the rest of the run is off the screen
+  lcd->cache_index_col += n*w;
+}
+
+char ili9341_draw_char_fast (ili9341_t *lcd, char character, uint16_t text_color, uint8_t text_scale, uint16_t bg_color) {
+  // check if character is out of range
+  if (!fontHas(character)) {
+    // out of range
+    return ILI9341_ERROR;
+  }
+
+  if ((lcd->cache_index_col > ILI9341_SIZE_X) || (lcd->cache_index_row > ILI9341_SIZE_Y)) {
+    return ILI9341_ERROR;
+  }
+
+  drawText(lcd, &character, 1, text_color, text_scale, bg_color);
+  // return exit
+  return ILI9341_SUCCESS;
+}
+
+/**
+ * @desc    Draw character 2x larger
+ *
+ * @param   ili9341_t* lcd
+ * @param   char -> character
+ * @param   uint16_t -> color
+ * @param   ILI9341_Sizes -> size
+ *
+ * @return  void
+ */
+char ili9341_draw_char (ili9341_t *lcd, char character, uint16_t color, ILI9341_Sizes size)
+{
+  // variables
+  uint8_t letter, idxCol, idxRow;
+  // check if character is out of range
+  if (!fontHas(character)) {
+    // out of range
+    return ILI9341_ERROR;
+  }
+  // last column of character array - 5 columns 
+  idxCol = CHARS_COLS_LENGTH;
+  // last row of character array - 8 rows / bits
+  idxRow = CHARS_ROWS_LENGTH;
+
+  // --------------------------------------
+  // SIZE X1 - normal font 1x high, 1x wide
+  // --------------------------------------
+  if (size == X1) {  
+    // loop through 5 bits
+    while (idxCol--) {
+      // read from ROM memory 
+      letter = FONTS[character - 32][idxCol];
+      // loop through 8 bits
+      while (idxRow--) {
+        // check if bit set
+        if (letter & (1 << idxRow)) {
+          // draw pixel 
+          ili9341_draw_pixel(lcd, lcd->cache_index_col + idxCol, lcd->cache_index_row + idxRow, color);
+        }
+      }
+      // fill index row again
+      idxRow = CHARS_ROWS_LENGTH;
+    }
+    // update x position
+    lcd->cache_index_col += CHARS_COLS_LENGTH + 1;
+  
+  // --------------------------------------
+  // SIZE X2 - font 2x higher, normal wide
+  // --------------------------------------
+  } else if (size == X2) {
+    // loop through 5 bytes
+    while (idxCol--) {
+      // read from ROM memory 
+      letter = FONTS[character - 32][idxCol];
+      // loop through 8 bits
+      while (idxRow--) {
+        // check if bit set
+        if (letter & (1 << idxRow)) {
+          // draw first left up pixel; 
+          // (idxRow << 1) - 2x multiplied 
+          ili9341_draw_pixel(lcd, lcd->cache_index_col + idxCol, lcd->cache_index_row + (idxRow << 1), color);
+          // draw second left down pixel
+          ili9341_draw_pixel(lcd, lcd->cache_index_col + idxCol, lcd->cache_index_row + (idxRow << 1) + 1, color);
+        }
+      }
+      // fill index row again
+      idxRow = CHARS_ROWS_LENGTH;
+    }
+    // update x position
+    lcd->cache_index_col += CHARS_COLS_LENGTH + 2;
+
+  // --------------------------------------
+  // SIZE X3 - font 2x higher, 2x wider
+  // --------------------------------------
+  } else if (size == X3) {
+    // loop through 5 bytes
+    while (idxCol--) {
+      // read from ROM memory 
+      letter = FONTS[character - 32][idxCol];
+      // loop through 8 bits
+      while (idxRow--) {
+        // check if bit set
+        if (letter & (1 << idxRow)) {
+          // draw first left up pixel; 
+          // (idxRow << 1) - 2x multiplied 
+          ili9341_draw_pixel(lcd, lcd->cache_index_col + (idxCol << 1), lcd->cache_index_row + (idxRow << 1), color);
+          // draw second left down pixel
+          ili9341_draw_pixel(lcd, lcd->cache_index_col + (idxCol << 1), lcd->cache_index_row + (idxRow << 1) + 1, color);
+          // draw third right up pixel
+          ili9341_draw_pixel(lcd, lcd->cache_index_col + (idxCol << 1) + 1, lcd->cache_index_row + (idxRow << 1), color);
+          // draw fourth right down pixel
+          ili9341_draw_pixel(lcd, lcd->cache_index_col + (idxCol << 1) + 1, lcd->cache_index_row + (idxRow << 1) + 1, color);
+        }
+      }
+      // fill index row again
+      idxRow = CHARS_ROWS_LENGTH;
+    }
+    // update x position *2
+    lcd->cache_index_col += (CHARS_COLS_LENGTH << 1) + 2;
+  }
+  _HW_HOOK(lcd, commit, NULL)
+  // return exit
+  return ILI9341_SUCCESS;
+}
+
+
+void ili9341_draw_string_fast (ili9341_t *lcd, char *str, uint16_t text_color, uint8_t size, uint16_t bg_color)
+{
+  // variables
+  unsigned int i = 0;
+  uint16_t n;
+  const char fallback = ILI9341_FALLBACK_CHAR;
+  uint16_t cell_w = (CHARS_COLS_LENGTH + 1) * size;
+  uint16_t delta_y = CHARS_ROWS_LENGTH * size;
+  // max y pos
+  uint16_t max_y_pos = ILI9341_SIZE_Y - delta_y;
+
+  // loop through the text lines of the string
+  while (str[i] != '\0') {
+    // control if the first character will be in range, wrapping to the next line
+    if (ILI9341_SUCCESS != ili9341_check_position(lcd, lcd->cache_index_col + CHARS_COLS_LENGTH*size,
+                                                  lcd->cache_index_row + delta_y, max_y_pos, size)) {
+      return;
+    }
+    if (lcd->cache_index_row > ILI9341_SIZE_Y) {
+      return;
+    }
+    if (!fontHas(str[i])) {
+      // one cell for the whole UTF-8 sequence of a character the font does not have
+      const char *next = &str[i];
+      ili9341_utf8_next(&next);
+      drawText(lcd, &fallback, 1, text_color, size, bg_color);
+      i = next - str;
+      continue;
+    }
+    // the characters whose glyph still fits the line go in one window
+    n = 1;
+    while (fontHas(str[i+n]) && (lcd->cache_index_col + n*cell_w + CHARS_COLS_LENGTH*size <= ILI9341_SIZE_X)) {
+      n++;
+    }
+    drawText(lcd, &str[i], n, text_color, size, bg_color);
+    i += n;
+  }
+}
+
+/**
+ * @desc    Draw string
+ *
+ * @param   ili9341_t* lcd
+ * @param   char* -> string 
+ * @param   uint16_t -> color
+ * @param   ILI9341_Sizes -> size
+ *
+ * @return  void
+ */
+void ili9341_draw_string (ili9341_t *lcd, char *str, uint16_t color, ILI9341_Sizes size)
+{
+  // variables
+  unsigned int i = 0;
+  char check;
+  uint16_t delta_y;
+  uint16_t max_y_pos;
+  uint16_t new_x_pos;
+  uint16_t new_y_pos;
+
+  // loop through character of string
+  while (str[i] != '\0') {
+    // max x position character
+    new_x_pos = lcd->cache_index_col + CHARS_COLS_LENGTH + (size & 0x0F);
+    // delta y
+    delta_y = CHARS_ROWS_LENGTH + (size >> 4);
+    // max y position character
+    new_y_pos = lcd->cache_index_row + delta_y;
+    // max y pos
+    max_y_pos = ILI9341_SIZE_Y - delta_y;
+    // control if will be in range
+    check = ili9341_check_position(lcd, new_x_pos, new_y_pos, max_y_pos, size);
+    // update position
+    if (ILI9341_SUCCESS == check) {
+      // read characters and increment index, a UTF-8 sequence or control the font does not have is one fallback cell
+      if (fontHas(str[i])) {
+        ili9341_draw_char(lcd, str[i++], color, size);
+      } else {
+        const char *next = &str[i];
+        ili9341_utf8_next(&next);
+        ili9341_draw_char(lcd, ILI9341_FALLBACK_CHAR, color, size);
+        i = next - str;
+      }
+    }
+  }
+}
+
+/**
+ * @desc    Check text position x, y
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t
+ * @param   uint16_t
+ * @param   uint16_t
+ * @param   ILI9341_Sizes
+ *
+ * @return  char
+ */
+char ili9341_check_position (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t max_y, ILI9341_Sizes size)
+{
+  /* TODO What is this params purpose? */
+  (void) size;
+  // check if coordinates is out of range
+  if ((x > ILI9341_SIZE_X) && (y > max_y)) {  
+    // error
+    return ILI9341_ERROR;
+  }
+  // if next line
+  if ((x > ILI9341_SIZE_X) && (y <= max_y)) {
+    // set position y
+    lcd->cache_index_row = y;
+    // set position x
+    lcd->cache_index_col = 2;
+  } 
+  // return exit
+  return ILI9341_SUCCESS;
+}
+
+/**
+ * @desc    LCD Set text position x, y
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t x - position
+ * @param   uint16_t y - position
+ *
+ * @return  char
+ */
+char ili9341_set_position (ili9341_t *lcd, uint16_t x, uint16_t y)
+{
+  // check if coordinates is out of range
+  if ((x > ILI9341_SIZE_X) && (y > ILI9341_SIZE_Y)) {
+    // error
+    return ILI9341_ERROR;
+  // x overflow, y in range
+  } else if ((x > ILI9341_SIZE_X) && (y <= ILI9341_SIZE_Y)) {
+    // set position y
+    lcd->cache_index_row = y;
+    // set position x
+    lcd->cache_index_col = 2;
+  } else {
+    // set position y 
+    lcd->cache_index_row = y;
+    // set position x
+    lcd->cache_index_col = x;
+  }
+  // return exit
+  return ILI9341_SUCCESS;
+}
+
+/** @struct State of a 1 bpp bitmap being scaled by nearest neighbour. Source column j * src_w / dst_w
+ *          and row i * src_h / dst_h of each pixel are stepped by their quotient and remainder instead
+ *          of divided; row and column-major bitmaps only differ in the bits between two source columns
+ *          and rows. */
+typedef struct {
+  const uint8_t *bitmap;
+  uint16_t dst_w, dst_h;
+  uint16_t col_bits, row_bits;  // bits from a source column / row to the next
+  uint32_t x_step, y_step;      // bits of the quotients
+  uint16_t x_frac, y_frac;      // remainders
+  uint16_t j;                   // column of the next pixel
+  uint32_t x_err, y_err;        // remainders of its source column and row, a remainder added to
+                                // one may pass 65535 before dst_w / dst_h is taken off again
+  uint32_t row, n;              // bit of the source row at column 0, bit of the next pixel
+  uint8_t fg[2], bg[2];         // colors on the wire
+} scaled_stream_t;
+
+/**
+ * @desc    Prepares the scaling of a bitmap to a non-empty dst_w x dst_h
+ *
+ * @param   scaled_stream_t* ss
+ * @param   uint16_t dst_w
+ * @param   uint16_t dst_h
+ * @param   const uint8_t* bitmap
+ * @param   uint16_t src_w
+ * @param   uint16_t src_h
+ * @param   uint16_t fg565
+ * @param   uint16_t bg565
+ * @param   bool col_major
+ *
+ * @return  void
+ */
+static void scaledStart(scaled_stream_t *ss, uint16_t dst_w, uint16_t dst_h, const uint8_t *bitmap, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565, bool col_major)
+{
+  ss->bitmap = bitmap;
+  ss->dst_w = dst_w;
+  ss->dst_h = dst_h;
+  ss->col_bits = col_major ? src_h : 1;
+  ss->row_bits = col_major ? 1 : src_w;
+  // the only divisions, once per bitmap
+  ss->x_step = (uint32_t) (src_w / dst_w) * ss->col_bits;
+  ss->x_frac = src_w % dst_w;
+  ss->y_step = (uint32_t) (src_h / dst_h) * ss->row_bits;
+  ss->y_frac = src_h % dst_h;
+  ss->j = 0;
+  ss->x_err = 0;
+  ss->y_err = 0;
+  ss->row = 0;
+  ss->n = 0;
+  ILI9341_RGB565_DECODETOBUF(ss->fg, fg565)
+  ILI9341_RGB565_DECODETOBUF(ss->bg, bg565)
+}
+
+/**
+ * @desc    Renders the next pixels of a scaled bitmap, row after row
+ *
+ * @param   scaled_stream_t* ss
+ * @param   uint8_t* dst
+ * @param   uint32_t count of pixels
+ *
+ * @return  void
+ */
+static void scaledPixels(scaled_stream_t *ss, uint8_t *dst, uint32_t count)
+{
+  uint32_t n = ss->n;
+  uint16_t j = ss->j;
+  uint32_t x_err = ss->x_err;
+
+  while (count--) {
+    const uint8_t *px = (ss->bitmap[n >> 3] & (1 << (n & 7))) ? ss->fg : ss->bg;
+    *dst++ = px[0];
+    *dst++ = px[1];
+    if (++j < ss->dst_w) {
+      n += ss->x_step;
+      x_err += ss->x_frac;
+      if (x_err >= ss->dst_w) {
+        x_err -= ss->dst_w;
+        n += ss->col_bits;
+      }
+    } else {
+      // next row
+      j = 0;
+      x_err = 0;
+      ss->row += ss->y_step;
+      ss->y_err += ss->y_frac;
+      if (ss->y_err >= ss->dst_h) {
+        ss->y_err -= ss->dst_h;
+        ss->row += ss->row_bits;
+      }
+      n = ss->row;
+    }
+  }
+  ss->n = n;
+  ss->j = j;
+  ss->x_err = x_err;
+}
+
+/**
+ * @desc    Renders a scaled bitmap into a buffer
+ *
+ * @param   uint8_t* dst
+ * @param   uint16_t dst_w
+ * @param   uint16_t dst_h
+ * @param   const uint8_t* src
+ * @param   uint16_t src_w
+ * @param   uint16_t src_h
+ * @param   uint16_t fg565
+ * @param   uint16_t bg565
+ * @param   bool col_major
+ *
+ * @return  void
+ */
+static void renderScaledBitmap(uint8_t *dst, uint16_t dst_w, uint16_t dst_h, const uint8_t *src, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565, bool col_major)
+{
+  scaled_stream_t ss;
+
+  if (!dst_w || !dst_h) {
+    return;
+  }
+  scaledStart(&ss, dst_w, dst_h, src, src_w, src_h, fg565, bg565, col_major);
+  scaledPixels(&ss, dst, (uint32_t) dst_w*dst_h);
+}
+
+void ILI9341_RenderScaledBitmap(uint8_t* dst, uint16_t dst_w, uint16_t dst_h, const uint8_t* src, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565) {
+  renderScaledBitmap(dst, dst_w, dst_h, src, src_w, src_h, fg565, bg565, false);
+}
+
+void ILI9341_RenderScaledBitmapColMajor(uint8_t* dst, uint16_t dst_w, uint16_t dst_h, const uint8_t* src, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565) {
+  renderScaledBitmap(dst, dst_w, dst_h, src, src_w, src_h, fg565, bg565, true);
+}
+
+void ILI9341_RenderBitmap(uint8_t* render_out, const uint8_t* bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565) {
+  // the bits of a row-major bitmap are its pixels in order
+  ili9341_expand_1bpp(render_out, bitmap, (uint32_t) w*h, fg565, bg565);
+}
+
+void ILI9341_RenderBitmapColMajor(uint8_t* render_out, const uint8_t* bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565) {
+  uint8_t fg[2], bg[2];
+  uint8_t bits = 0, left = 0;
+
+  ILI9341_RGB565_DECODETOBUF(fg, fg565)
+  ILI9341_RGB565_DECODETOBUF(bg, bg565)
+  // the bits are read in order, a byte at a time, and go down the columns
+  for (uint16_t x = 0; x < w; x++) {
+    uint8_t *px = render_out + x*2;
+    for (uint16_t y = 0; y < h; y++) {
+      if (!left) {
+        bits = *bitmap++;
+        left = 8;
+      }
+      memcpy(px, (bits & 1) ? fg : bg, 2);
+      bits >>= 1;
+      left--;
+      px += (uint32_t) w*2;
+    }
+  }
+}
+
+/** @struct State of a gradient being streamed */
+typedef struct {
+  uint16_t w;
+  uint16_t x;             // next pixel
+  uint16_t t;             // position along the gradient
+  uint16_t n;             // steps along the gradient
+  bool horizontal;
+  int8_t r0, g0, b0;      // first color
+  int8_t dr, dg, db;      // last color minus first color
+  uint8_t px[2];          // color of t on the wire
+} gradient_stream_t;
+
+/**
+ * @desc    Encodes the gradient color at position t
+ *
+ * @param   gradient_stream_t*
+ *
+ * @return  void
+ */
+static void gradientColor(gradient_stream_t *gs)
+{
+  uint8_t r = gs->r0 + (int16_t) gs->dr * gs->t / gs->n;
+  uint8_t g = gs->g0 + (int16_t) gs->dg * gs->t / gs->n;
+  uint8_t b = gs->b0 + (int16_t) gs->db * gs->t / gs->n;
+  uint16_t color = ILI9341_RGB565(r, g, b);
+
+  ILI9341_RGB565_DECODETOBUF(gs->px, color)
+}
+
+/**
+ * @desc    Renders the pixels of a gradient row by row, the color only changes when t moves
+ *
+ * @param   void* arg gradient_stream_t
+ * @param   uint8_t* buf
+ * @param   uint16_t len
+ *
+ * @return  void
+ */
+static void renderGradient(void *arg, uint8_t *buf, uint16_t len)
+{
+  gradient_stream_t *gs = arg;
+
+  for (uint16_t i=0; i<len; i+=2) {
+    buf[i] = gs->px[0];
+    buf[i+1] = gs->px[1];
+    if (++gs->x == gs->w) {
+      gs->x = 0;
+    }
+    // next column or next row moves along the gradient
+    if (gs->horizontal || gs->x == 0) {
+      gs->t = (gs->horizontal && gs->x == 0) ? 0 : gs->t + 1;
+      gradientColor(gs);
+    }
+  }
+}
+
+char ili9341_draw_gradient_rect (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c0, uint16_t c1, bool horizontal)
+{
+  gradient_stream_t gs;
+  uint16_t steps = horizontal ? w : h;
+
+  gs.w = w;
+  gs.x = 0;
+  gs.t = 0;
+  gs.n = (steps > 1) ? steps - 1 : 1;
+  gs.horizontal = horizontal;
+  gs.r0 = RGBR(c0);
+  gs.g0 = RGBG(c0);
+  gs.b0 = RGBB(c0);
+  gs.dr = RGBR(c1) - gs.r0;
+  gs.dg = RGBG(c1) - gs.g0;
+  gs.db = RGBB(c1) - gs.b0;
+  gradientColor(&gs);
+
+  return ili9341_stream_rect(lcd, x, y, w, h, renderGradient, &gs);
+}
+
+/** @struct State of a row-major 1 bpp bitmap being streamed unscaled, its bits are the pixels in order */
+typedef struct {
+  const uint8_t *bitmap;
+  uint32_t n;             // bit of the next pixel
+  uint16_t fg565, bg565;
+  uint8_t fg[2], bg[2];   // colors on the wire
+} bits_stream_t;
+
+/**
+ * @desc    Expands the next bits of a bitmap, from the next whole byte on through the expansion kernel
+ *
+ * @param   void* arg bits_stream_t
+ * @param   uint8_t* buf
+ * @param   uint16_t len
+ *
+ * @return  void
+ */
+static void renderBits(void *arg, uint8_t *buf, uint16_t len)
+{
+  bits_stream_t *bs = arg;
+  uint16_t count = len / 2;
+
+  // a chunk ending within a byte leaves the next one starting there
+  for (; count && (bs->n & 7); count--, bs->n++, buf += 2) {
+    memcpy(buf, (bs->bitmap[bs->n >> 3] & (1 << (bs->n & 7))) ? bs->fg : bs->bg, 2);
+  }
+  ili9341_expand_1bpp(buf, &bs->bitmap[bs->n >> 3], count, bs->fg565, bs->bg565);
+  bs->n += count;
+}
+
+/**
+ * @desc    Renders the next pixels of a scaled bitmap
+ *
+ * @param   void* arg scaled_stream_t
+ * @param   uint8_t* buf
+ * @param   uint16_t len
+ *
+ * @return  void
+ */
+static void renderScaled(void *arg, uint8_t *buf, uint16_t len)
+{
+  scaledPixels(arg, buf, len / 2);
+}
+
+/**
+ * @desc    Streams a bitmap scaled to w x h in either bit order, a row-major one of that size through the
+ *          expansion kernel
+ *
+ * @param   ili9341_t* lcd
+ * @param   uint16_t x
+ * @param   uint16_t y
+ * @param   uint16_t w
+ * @param   uint16_t h
+ * @param   const uint8_t* bitmap
+ * @param   uint16_t src_w
+ * @param   uint16_t src_h
+ * @param   uint16_t fg565
+ * @param   uint16_t bg565
+ * @param   bool col_major
+ *
+ * @return  char
+ */
+static char drawBitmap(ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *bitmap, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565, bool col_major)
+{
+  scaled_stream_t ss;
+
+  if (!w || !h) {
+    return ILI9341_ERROR;
+  }
+  if (!col_major && w == src_w && h == src_h) {
+    bits_stream_t bs = {.bitmap=bitmap, .n=0, .fg565=fg565, .bg565=bg565};
+    ILI9341_RGB565_DECODETOBUF(bs.fg, fg565)
+    ILI9341_RGB565_DECODETOBUF(bs.bg, bg565)
+    return ili9341_stream_rect(lcd, x, y, w, h, renderBits, &bs);
+  }
+  scaledStart(&ss, w, h, bitmap, src_w, src_h, fg565, bg565, col_major);
+  return ili9341_stream_rect(lcd, x, y, w, h, renderScaled, &ss);
+}
+
+char ili9341_draw_bitmap (ili9341_t *lcd, uint16_t x, uint16_t y, const uint8_t *bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565)
+{
+  return drawBitmap(lcd, x, y, w, h, bitmap, w, h, fg565, bg565, false);
+}
+
+char ili9341_draw_bitmap_col_major (ili9341_t *lcd, uint16_t x, uint16_t y, const uint8_t *bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565)
+{
+  return drawBitmap(lcd, x, y, w, h, bitmap, w, h, fg565, bg565, true);
+}
+
+char ili9341_draw_scaled_bitmap (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *bitmap, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565)
+{
+  return drawBitmap(lcd, x, y, w, h, bitmap, src_w, src_h, fg565, bg565, false);
+}
+
+char ili9341_draw_scaled_bitmap_col_major (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *bitmap, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565)
+{
+  return drawBitmap(lcd, x, y, w, h, bitmap, src_w, src_h, fg565, bg565, true);
+}
+
+// DEFAULT INSTANCE
+// ---------------------------------------------------------------
+
+void ILI9341_SetData (void)
+{
+  ili9341_set_data(&_ili9341_default);
+}
+
+void ILI9341_Barrier (void)
+{
+  ili9341_barrier(&_ili9341_default);
+}
+
+void ILI9341_Init (void)
+{
+  ili9341_init(&_ili9341_default);
+}
+
+void ILI9341_InitStart (ILI9341_Boot profile)
+{
+  ili9341_init_start(&_ili9341_default, profile);
+}
+
+uint32_t ILI9341_InitStep (void)
+{
+  return ili9341_init_step(&_ili9341_default);
+}
+
+void ILI9341_HWReset (void)
+{
+  ili9341_hw_reset(&_ili9341_default);
+}
+
+void ILI9341_InvalidateShadow (void)
+{
+  ili9341_invalidate_shadow(&_ili9341_default);
+}
+
+void ILI9341_TransmitCmmd (uint8_t cmmd)
+{
+  ili9341_transmit_cmmd(&_ili9341_default, cmmd);
+}
+
+void ILI9341_Transmit8bitData (uint8_t data)
+{
+  ili9341_transmit_8bit_data(&_ili9341_default, data);
+}
+
+void ILI9341_Transmit16bitData (uint16_t data)
+{
+  ili9341_transmit_16bit_data(&_ili9341_default, data);
+}
+
+void ILI9341_Transmit32bitData (uint32_t data)
+{
+  ili9341_transmit_32bit_data(&_ili9341_default, data);
+}
+
+char ILI9341_SetWindow (uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
+{
+  return ili9341_set_window(&_ili9341_default, xs, ys, xe, ye);
+}
+
+char ILI9341_DrawRect (uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+  return ili9341_draw_rect(&_ili9341_default, x, y, w, h, color);
+}
+
+char ILI9341_DrawPixel (uint16_t x, uint16_t y, uint16_t color)
+{
+  return ili9341_draw_pixel(&_ili9341_default, x, y, color);
+}
+
+void ILI9341_SendColor565 (uint16_t color, uint32_t count)
+{
+  ili9341_send_color565(&_ili9341_default, color, count);
+}
+
+void ILI9341_ClearScreen (uint32_t color)
+{
+  ili9341_clear_screen(&_ili9341_default, color);
+}
+
+void ILI9341_WritePatternRect (uint8_t *pattern_buf, uint16_t len, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  ili9341_write_pattern_rect(&_ili9341_default, pattern_buf, len, x, y, w, h);
+}
+
+char ILI9341_StreamRect (uint16_t x, uint16_t y, uint16_t w, uint16_t h, ili9341_render_fn render, void *arg)
+{
+  return ili9341_stream_rect(&_ili9341_default, x, y, w, h, render, arg);
+}
+
+char ILI9341_DrawGradientRect (uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c0, uint16_t c1, bool horizontal)
+{
+  return ili9341_draw_gradient_rect(&_ili9341_default, x, y, w, h, c0, c1, horizontal);
+}
+
+char ILI9341_DrawBitmap (uint16_t x, uint16_t y, const uint8_t *bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565)
+{
+  return ili9341_draw_bitmap(&_ili9341_default, x, y, bitmap, w, h, fg565, bg565);
+}
+
+char ILI9341_DrawBitmapColMajor (uint16_t x, uint16_t y, const uint8_t *bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565)
+{
+  return ili9341_draw_bitmap_col_major(&_ili9341_default, x, y, bitmap, w, h, fg565, bg565);
+}
+
+char ILI9341_DrawScaledBitmap (uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *bitmap, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565)
+{
+  return ili9341_draw_scaled_bitmap(&_ili9341_default, x, y, w, h, bitmap, src_w, src_h, fg565, bg565);
+}
+
+char ILI9341_DrawScaledBitmapColMajor (uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *bitmap, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565)
+{
+  return ili9341_draw_scaled_bitmap_col_major(&_ili9341_default, x, y, w, h, bitmap, src_w, src_h, fg565, bg565);
+}
+
+#ifdef ILI9341_FRAMEBUFFER
+void ILI9341_AttachFramebuffer (uint8_t *fb)
+{
+  ili9341_attach_framebuffer(&_ili9341_default, fb);
+}
+
+char ILI9341_AttachStrip (uint8_t *strip, uint16_t ys, uint16_t ye, uint16_t bg)
+{
+  return ili9341_attach_strip(&_ili9341_default, strip, ys, ye, bg);
+}
+
+void ILI9341_SetWindowCost (uint16_t window_cost)
+{
+  ili9341_set_window_cost(&_ili9341_default, window_cost);
+}
+
+void ILI9341_Flush (void)
+{
+  ili9341_flush(&_ili9341_default);
+}
+
+void ILI9341_AttachPrevFrame (uint8_t *prev)
+{
+  ili9341_attach_prev_frame(&_ili9341_default, prev);
+}
+#endif
+
+void ILI9341_InverseScreen (void)
+{
+  ili9341_inverse_screen(&_ili9341_default);
+}
+
+void ILI9341_NormalScreen (void)
+{
+  ili9341_normal_screen(&_ili9341_default);
+}
+
+void ILI9341_SetMemoryAccess (uint8_t madctl)
+{
+  ili9341_set_memory_access(&_ili9341_default, madctl);
+}
+
+void ILI9341_SetPixelFormat (uint8_t colmod)
+{
+  ili9341_set_pixel_format(&_ili9341_default, colmod);
+}
+
+char ILI9341_SetScrollArea (uint16_t top, uint16_t bottom)
+{
+  return ili9341_set_scroll_area(&_ili9341_default, top, bottom);
+}
+
+void ILI9341_Scroll (int16_t lines)
+{
+  ili9341_scroll(&_ili9341_default, lines);
+}
+
+void ILI9341_UpdateScreen (void)
+{
+  ili9341_update_screen(&_ili9341_default);
+}
+
+void ILI9341_DrawLine (uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, uint16_t color)
+{
+  ili9341_draw_line(&_ili9341_default, x1, x2, y1, y2, color);
+}
+
+char ILI9341_DrawLineHorizontal (uint16_t xs, uint16_t xe, uint16_t y, uint16_t color)
+{
+  return ili9341_draw_line_horizontal(&_ili9341_default, xs, xe, y, color);
+}
+
+char ILI9341_DrawLineVertical (uint16_t x, uint16_t ys, uint16_t ye, uint16_t color)
+{
+  return ili9341_draw_line_vertical(&_ili9341_default, x, ys, ye, color);
+}
+
+char ILI9341_DrawCharFast (char character, uint16_t text_color, uint8_t text_scale, uint16_t bg_color)
+{
+  return ili9341_draw_char_fast(&_ili9341_default, character, text_color, text_scale, bg_color);
+}
+
+char ILI9341_AttachGlyphCache (uint8_t *pool, uint32_t len, uint8_t max_scale)
+{
+  return ili9341_attach_glyph_cache(&_ili9341_default, pool, len, max_scale);
+}
+
+void ILI9341_GlyphCacheStats (uint32_t *hits, uint32_t *misses)
+{
+  ili9341_glyph_cache_stats(&_ili9341_default, hits, misses);
+}
+
+char ILI9341_DrawChar (char character, uint16_t color, ILI9341_Sizes size)
+{
+  return ili9341_draw_char(&_ili9341_default, character, color, size);
+}
+
+void ILI9341_DrawStringFast (char *str, uint16_t text_color, uint8_t size, uint16_t bg_color)
+{
+  ili9341_draw_string_fast(&_ili9341_default, str, text_color, size, bg_color);
+}
+
+void ILI9341_DrawString (char *str, uint16_t color, ILI9341_Sizes size)
+{
+  ili9341_draw_string(&_ili9341_default, str, color, size);
+}
+
+char ILI9341_CheckPosition (uint16_t x, uint16_t y, uint16_t max_y, ILI9341_Sizes size)
+{
+  return ili9341_check_position(&_ili9341_default, x, y, max_y, size);
+}
+
+char ILI9341_SetPosition (uint16_t x, uint16_t y)
+{
+  return ili9341_set_position(&_ili9341_default, x, y);
 }
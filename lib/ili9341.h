@@ -95,8 +95,187 @@
     void (*barrier)(void *_unused);
   } ili9341_hw_intf_t;
 
+  // STATIC HAL BINDING
+  // ---------------------------------------------------------------
+  // Building the library with -DILI9341_STATIC_HAL='"my_hal.h"' binds the hooks at compile time instead of
+  // through ili9341_hw_intf_t. my_hal.h defines function-like macros which receive the instance and the same
+  // argument as the hook (NULL for commit and barrier):
+  //
+  //   ILI9341_HAL_RESET_PIN(lcd, level)   ILI9341_HAL_DC_PIN(lcd, level)   ILI9341_HAL_CS_PIN(lcd, level)
+  //   ILI9341_HAL_DELAY(lcd, us)          ILI9341_HAL_SENDBUF(lcd, buf)    ILI9341_HAL_SENDBYTE(lcd, byte)
+  //   ILI9341_HAL_COMMIT(lcd, unused)     ILI9341_HAL_BARRIER(lcd, unused)
+  //
+  // Undefined macros are no-ops, sendbuf is treated as absent. The macros (or static inline functions they
+  // call) are expanded into the driver so the compiler can inline every byte transfer, there is no NULL
+  // check and no indirect call. The hw_intf of the instances is ignored in this build.
+
+  // DRIVER INSTANCE
+  // ---------------------------------------------------------------
+  // Size in bytes of the repeated-color buffer solid fills stream through sendbuf
+  // (even, at most 65534). Larger buffers mean fewer sendbuf calls per fill.
+  #ifndef ILI9341_FILL_BUF_LEN
+    #define ILI9341_FILL_BUF_LEN  64
+  #endif
+  // Size in bytes of each of the two buffers rendered pixels stream through (even, at most 65534).
+  // One buffer is rendered while the other is on the wire.
+  #ifndef ILI9341_STREAM_BUF_LEN
+    #define ILI9341_STREAM_BUF_LEN  64
+  #endif
+  // Character cells of cached text sent with one window, their slots are looked up before it is opened
+  // and pointed to from the stack. Longer runs of a text line take a window per this many cells.
+  #ifndef ILI9341_GLYPH_RUN
+    #define ILI9341_GLYPH_RUN     16
+  #endif
+
+  /**
+   * \brief Renders the next pixels of a streamed rectangle
+   *
+   * Called with len (even) bytes to fill with big-endian 565 pixels, continuing where the previous call
+   * stopped, in the row order of the window. The buffer is not in flight while the function runs.
+   */
+  typedef void (*ili9341_render_fn)(void *arg, uint8_t *buf, uint16_t len);
+
+  /** @struct Rectangle, inclusive corners as in ILI9341_SetWindow */
+  typedef struct {
+    uint16_t xs, ys;
+    uint16_t xe, ye;
+  } ili9341_rect_t;
+
+  // FRAMEBUFFER
+  // ---------------------------------------------------------------
+  // Building the library with -DILI9341_FRAMEBUFFER adds an off-screen mode for targets with RAM for the whole
+  // frame (ILI9341_FB_SIZE bytes). While a framebuffer is attached the drawing functions write pixels into it
+  // and record the damaged areas; ILI9341_Flush() sends only those, one window and RAMWR per area.
+  // Targets without that RAM attach a strip of rows instead (see ili9341_queue_draw_bands).
+  #ifdef ILI9341_FRAMEBUFFER
+    // damaged areas tracked before they are merged
+    #ifndef ILI9341_DIRTY_MAX
+      #define ILI9341_DIRTY_MAX   16
+    #endif
+    // bus cost of sending an area on its own, in wire byte times next to 2 per pixel:
+    // CASET, PASET and RAMWR are 11 bytes, their 6 D/C toggles are counted as a byte each
+    #ifndef ILI9341_WINDOW_COST
+      #define ILI9341_WINDOW_COST 17
+    #endif
+  #endif
+  // size of a framebuffer, pixels as they go on the wire (big-endian 565), row after row
+  #define ILI9341_FB_SIZE       (ILI9341_MAX_X * ILI9341_MAX_Y * 2)
+  // size of a strip buffer holding some full-width rows of the frame
+  #define ILI9341_STRIP_SIZE(rows)  ((uint32_t) ILI9341_MAX_X * (rows) * 2)
+
+  /** @struct Header of a glyph cache slot, members are private to the driver */
+  typedef struct {
+    uint32_t used;            // cache clock of the last use, 0 if the slot is empty
+    uint16_t fg, bg;
+    char character;
+    uint8_t scale;
+  } ili9341_glyph_t;
+
+  // size of a glyph cache slot holding a character cell of up to scale, header and 6x8 * scale pixels
+  #define ILI9341_GLYPH_SLOT_SIZE(scale)  ((sizeof(ili9341_glyph_t) + 96UL * (scale) * (scale) + 3) & ~3UL)
+
+  // character the built-in font draws in place of the ones it does not have (controls, non-ASCII)
+  #define ILI9341_FALLBACK_CHAR '?'
+  // codepoint a malformed UTF-8 sequence decodes to
+  #define ILI9341_UTF8_INVALID  0xFFFDUL
+
+  /**
+   * \brief State of one panel
+   *
+   * Every ILI9341_* function operates on a default instance bound with ili9341_set_hw_intf(). To drive several
+   * panels, prepare one ili9341_t per panel with ili9341_ctx_init() and use the ili9341_* variants, which take
+   * the instance as their first argument. Members are private to the driver.
+   */
+  typedef struct {
+    const ili9341_hw_intf_t *hw_intf;
+
+    // text cursor
+    uint16_t cache_index_row;
+    uint16_t cache_index_col;
+
+    // shadow of the last values written to the controller registers
+    struct {
+      uint8_t valid;          // flags of the fields below holding the register value
+      uint16_t xs, xe;        // CASET
+      uint16_t ys, ye;        // PASET
+      uint8_t madctl;         // MADCTL
+      uint8_t colmod;         // COLMOD
+      bool inverted;          // DINVON / DINVOFF
+    } shadow;
+
+    // repeated-color buffer for solid fills through sendbuf
+    uint8_t fill_buf[ILI9341_FILL_BUF_LEN];
+    uint16_t fill_color;
+    bool fill_valid;
+
+    // ping-pong buffers for rendered pixels, stream_cur is the one not sent last
+    uint8_t stream_buf[2][ILI9341_STREAM_BUF_LEN];
+    uint8_t stream_cur;
+
+    // resumable init
+    struct {
+      uint8_t state;
+      uint8_t profile;
+      uint8_t left;           // commands of INIT_ILI9341 not sent yet
+      const uint8_t *next;    // next command of INIT_ILI9341
+    } boot;
+
+    // hardware scrolling, rows tfa to tfa+vsa-1 of the screen show GRAM rows moved by off
+    struct {
+      uint16_t tfa, vsa;      // top fixed rows, scrolling rows (none defined if 0)
+      uint16_t off;           // lines scrolled, below vsa
+      uint16_t xs, ys;        // screen window being written
+      uint16_t xe, ye;
+      uint16_t row;           // first screen row of the part of the window being written
+    } scroll;
+
+    // glyph cache, rendered character cells in slots of pool, NULL if none
+    struct {
+      uint8_t *pool;
+      uint16_t slots;
+      uint16_t slot_len;
+      uint8_t max_scale;
+      uint32_t clock;         // incremented on every lookup
+      uint32_t hits, misses;
+    } glyphs;
+
+  #ifdef ILI9341_FRAMEBUFFER
+    // off-screen frame, NULL while drawing goes to the panel
+    uint8_t *fb;
+    uint16_t fb_ys, fb_ye;    // panel rows held by fb, all of them unless it is a strip
+    ili9341_rect_t fb_win;    // window set by ili9341_set_window
+    uint16_t fb_x, fb_y;      // next pixel of the memory write
+    bool fb_inflight;         // parts of fb may still be read by sendbuf
+    ili9341_rect_t dirty[ILI9341_DIRTY_MAX];
+    uint8_t ndirty;
+    uint8_t dirty_max;        // areas kept apart, 1 for a strip
+    uint16_t window_cost;     // ILI9341_WINDOW_COST if 0
+    uint8_t *prev;            // frame on the panel, flushes send only what differs from it
+  #endif
+  } ili9341_t;
+
+  /**
+   * \brief Binds the hw interface of the default instance
+   */
   void ili9341_set_hw_intf(const ili9341_hw_intf_t *hw_intf);
 
+  /**
+   * \brief Prepares an instance for a panel, nothing is sent to the panel
+   */
+  void ili9341_ctx_init(ili9341_t *lcd, const ili9341_hw_intf_t *hw_intf);
+
+  /**
+   * \brief Returns the default instance the ILI9341_* functions operate on
+   */
+  ili9341_t *ili9341_default(void);
+
+  /**
+   * \brief Decodes the UTF-8 character at *str and moves *str past it. A malformed sequence (stray
+   *        continuation byte, overlong or truncated sequence, surrogate, beyond U+10FFFF) decodes to
+   *        ILI9341_UTF8_INVALID and *str moves on by a single byte. Never reads past a terminating '\0'.
+   */
+  uint32_t ili9341_utf8_next(const char **str);
+
 
   // COMMAND DEFINITION
   // ---------------------------------------------------------------
@@ -228,6 +407,18 @@
     X3 = 0x81
   } ILI9341_Sizes;
 
+  /** @enum Init profiles */
+  typedef enum {
+    // reset and delays exactly as INIT_ILI9341, like ILI9341_Init
+    ILI9341_BOOT_NORMAL,
+    // no SWRESET after the hardware reset, no CS settle time,
+    // 5 ms after SLPOUT and none after DISPON (datasheet minimums)
+    ILI9341_BOOT_FAST
+  } ILI9341_Boot;
+
+  // returned by ILI9341_InitStep once the panel is initialized
+  #define ILI9341_INIT_DONE     0
+
   /** @const Command list ILI9341B */
   extern const uint8_t INIT_ILI9341[];
 
@@ -240,6 +431,28 @@
    */
   void ILI9341_Init (void);
 
+  /**
+   * @desc    LCD Start a resumable init, nothing is sent until ILI9341_InitStep
+   *
+   * @param   ILI9341_Boot profile
+   *
+   * @return  void
+   */
+  void ILI9341_InitStart (ILI9341_Boot);
+
+  /**
+   * @desc    LCD Run the init until it has to wait. Call again once the returned time has passed,
+   *          the rest of the firmware runs in between:
+   *
+   *            ILI9341_InitStart(ILI9341_BOOT_FAST);
+   *            while ((wait = ILI9341_InitStep()) != ILI9341_INIT_DONE) { ... at least wait us later ... }
+   *
+   * @param   void
+   *
+   * @return  uint32_t microseconds to wait before the next call, ILI9341_INIT_DONE when finished
+   */
+  uint32_t ILI9341_InitStep (void);
+
   /**
    * @desc    LCD Hardware Reset
    *
@@ -249,6 +462,18 @@
    */
   void ILI9341_HWReset (void);
 
+  /**
+   * @desc    LCD Invalidate register shadow
+   *          The driver remembers the CASET/PASET/MADCTL/COLMOD/inversion values it sent
+   *          and skips commands that would not change them. Call this if the controller
+   *          was reset or written to behind the driver's back.
+   *
+   * @param   void
+   *
+   * @return  void
+   */
+  void ILI9341_InvalidateShadow (void);
+
  /**
    * @desc    LCD Init PORTs
    *
@@ -258,6 +483,24 @@
    */
   void ILI9341_InitPorts (void);
 
+  /**
+   * @desc    LCD Select the device in data mode
+   *
+   * @param   void
+   *
+   * @return  void
+   */
+  void ILI9341_SetData (void);
+
+  /**
+   * @desc    LCD Wait until the buffers handed to sendbuf are no longer in use
+   *
+   * @param   void
+   *
+   * @return  void
+   */
+  void ILI9341_Barrier (void);
+
   /**
    * @desc    LCD Transmit Command
    *
@@ -296,6 +539,7 @@
 
   /**
    * @desc    LCD Set window
+   *          CASET and PASET are only sent for the axes that differ from the current window
    *
    * @param   uint16_t
    * @param   uint16_t
@@ -308,6 +552,8 @@
 
   /**
    * @desc    LCD Write Color Pixels
+   *          If the sendbuf hook is present the pixels are streamed from a repeated-color
+   *          buffer of ILI9341_FILL_BUF_LEN bytes, which may still be in flight on return.
    *
    * @param   uint16_t
    * @param   uint32_t
@@ -367,6 +613,47 @@
    */
   void ILI9341_NormalScreen (void);
 
+  /**
+   * @desc    LCD Memory Access Control (MADCTL), skipped if unchanged
+   *
+   * @param   uint8_t
+   *
+   * @return  void
+   */
+  void ILI9341_SetMemoryAccess (uint8_t);
+
+  /**
+   * @desc    LCD Pixel Format Set (COLMOD), skipped if unchanged
+   *
+   * @param   uint8_t
+   *
+   * @return  void
+   */
+  void ILI9341_SetPixelFormat (uint8_t);
+
+  /**
+   * @desc    Defines the vertical scrolling area (VSCRDEF): fixed rows at the top and at the bottom, the rows
+   *          between them scroll. The scroll position is reset (VSSAD).
+   *
+   * @param   uint16_t top fixed rows at the top
+   * @param   uint16_t bottom fixed rows at the bottom
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if no row is left to scroll
+   */
+  char ILI9341_SetScrollArea (uint16_t top, uint16_t bottom);
+
+  /**
+   * @desc    Scrolls the scrolling area by updating VSSAD, the whole screen if no area was defined. Positive
+   *          lines move the content up; the rows coming in at the bottom show what left at the top, clear
+   *          and redraw them. Drawing keeps using screen coordinates, rows of the scrolling area are
+   *          translated to the GRAM rows shown there (a window crossing its edges is written in parts).
+   *
+   * @param   int16_t lines
+   *
+   * @return  void
+   */
+  void ILI9341_Scroll (int16_t lines);
+
   /**
    * @desc    LCD Update Screen
    *
@@ -378,6 +665,7 @@
 
   /**
    * @desc    LCD Draw line by Bresenham algoritm - depend on MADCTL
+   *          Every horizontal / vertical run of the line is sent as one window
    *  
    * @param   uint16_t - x start position / 0 <= cols <= ILI9341_SIZE_X
    * @param   uint16_t - x end position   / 0 <= cols <= ILI9341_SIZE_X
@@ -413,6 +701,45 @@
    */
   char ILI9341_DrawLineVertical (uint16_t, uint16_t, uint16_t, uint16_t);
 
+  /**
+   * @desc    LCD Draw character with background in a single window, at any integer scale.
+   *          The cell is clipped at the right and bottom edge of the screen.
+   *
+   * @param   char -> character
+   * @param   uint16_t -> text color
+   * @param   uint8_t -> scale
+   * @param   uint16_t -> background color
+   *
+   * @return  char ILI9341_ERROR if the font has no such character (0x20 to 0x7f) or the cursor is off screen
+   */
+  char ILI9341_DrawCharFast (char, uint16_t, uint8_t, uint16_t);
+
+  /**
+   * @desc    Attaches a pool the cells drawn by ILI9341_DrawCharFast and ILI9341_DrawStringFast are kept in,
+   *          rendered as they go on the wire and keyed by character, scale and colors. The cells of a text line
+   *          are looked up first, a missing one is rendered into the least recently used slot, then their rows
+   *          are copied out of the pool into the stream buffers of a single window, as without a cache (up to
+   *          ILI9341_GLYPH_RUN cells and no more than the pool has slots per window). Scales above max_scale
+   *          are rendered as without a cache. Attaching resets the pool and the counters, NULL detaches it.
+   *
+   * @param   uint8_t* pool aligned for uint32_t, a multiple of ILI9341_GLYPH_SLOT_SIZE(max_scale) bytes
+   * @param   uint32_t len bytes of the pool
+   * @param   uint8_t max_scale largest scale cached, up to 26, slots are sized for it
+   *
+   * @return  char ILI9341_ERROR if not a single slot fits
+   */
+  char ILI9341_AttachGlyphCache (uint8_t *pool, uint32_t len, uint8_t max_scale);
+
+  /**
+   * @desc    Lookups of the glyph cache since it was attached, to size the pool
+   *
+   * @param   uint32_t* hits cells sent out of the pool
+   * @param   uint32_t* misses cells rendered into it
+   *
+   * @return  void
+   */
+  void ILI9341_GlyphCacheStats (uint32_t *hits, uint32_t *misses);
+
   /**
    * @desc    LCD Draw character 2x larger
    *
@@ -420,7 +747,7 @@
    * @param   uint16_t -> color
    * @param   ILI9341_Sizes -> size
    *
-   * @return  void
+   * @return  char ILI9341_ERROR if the font has no such character (0x20 to 0x7f)
    */
   char ILI9341_DrawChar (char, uint16_t, ILI9341_Sizes);
 
@@ -450,7 +777,11 @@
    * @desc    Draws a string with background.
    *
    *          Drawing the text as a full block is far faster due to the lack of
-   *          D/C switches and small transfers required.
+   *          D/C switches and small transfers required. The characters of a text
+   *          line go out with a single window and RAMWR, their glyph rows rendered
+   *          across the whole line into the stream buffers (see ILI9341_StreamRect).
+   *          The string is UTF-8: a character the font does not have takes one cell
+   *          with ILI9341_FALLBACK_CHAR.
    *
    * @param   char* -> string
    * @param   uint16_t -> color
@@ -461,7 +792,7 @@
   void ILI9341_DrawStringFast (char *str, uint16_t text_color, uint8_t size, uint16_t bg_color);
 
   /**
-   * @desc    Draw string
+   * @desc    Draw string, UTF-8 as ILI9341_DrawStringFast
    *
    * @param   char* -> string 
    * @param   uint16_t -> color
@@ -481,7 +812,8 @@
   void ILI9341_Delay (uint16_t);
 
   /**
-   * @desc    Renders a bitmap into pixel data in a memory buffer, scaling if the src and dst sizes are different
+   * @desc    Renders a bitmap into pixel data in a memory buffer, scaling if the src and dst sizes are different.
+   *          ILI9341_DrawScaledBitmap sends the same pixels without the buffer.
    *
    * @param   uint8_t* dst The buffer to write into. Must be at least dst_w*dst_h*2 bytes long because each pixel is two bytes
    * @param   uint16_t dst_w The width of the destination rectangle
@@ -514,7 +846,8 @@
   void ILI9341_RenderScaledBitmapColMajor(uint8_t* dst, uint16_t dst_w, uint16_t dst_h, const uint8_t* src, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565);
 
   /**
-   * @desc    Renders a bitmap into pixel data in a memory buffer without scaling.
+   * @desc    Renders a bitmap into pixel data in a memory buffer without scaling, through the
+   *          1 bpp expansion kernel of the CPU (see ili9341_expand_1bpp in ili9341_pixel.h).
    *
    * @param   uint8_t* render_out The buffer to write into. Must be at least w*h*2 bytes long because each pixel is two bytes
    * @param   uint8_t* bitmap The buffer of the bitmap being read from
@@ -559,4 +892,313 @@
    */
   void ILI9341_WritePatternRect(uint8_t *pattern_buf, uint16_t len, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
 
+  /**
+   * @desc    Streams a rectangle of rendered pixels. The pixels are produced ILI9341_STREAM_BUF_LEN bytes
+   *          at a time by the render function into two alternating buffers: the next chunk is rendered
+   *          while the previous one is still on the wire, and barrier is only called before a chunk is
+   *          sent. The last chunk may still be in flight on return. Without the sendbuf hook every chunk
+   *          goes out through sendbyte.
+   *
+   * @param   uint16_t x The starting X coordinate
+   * @param   uint16_t y The starting Y coordinate
+   * @param   uint16_t w The width of the rectangle in pixels
+   * @param   uint16_t h The height of the rectangle in pixels
+   * @param   ili9341_render_fn render Produces the pixels
+   * @param   void* arg Passed to render
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if the rectangle is empty or off the screen
+   */
+  char ILI9341_StreamRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, ili9341_render_fn render, void *arg);
+
+  /**
+   * @desc    Draws a rectangle filled with a linear gradient, streamed as it is computed
+   *
+   * @param   uint16_t x The starting X coordinate
+   * @param   uint16_t y The starting Y coordinate
+   * @param   uint16_t w The width of the rectangle in pixels
+   * @param   uint16_t h The height of the rectangle in pixels
+   * @param   uint16_t c0 The 565 color of the first column / row
+   * @param   uint16_t c1 The 565 color of the last column / row
+   * @param   bool horizontal true to change the color from left to right, false from top to bottom
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if the rectangle is empty or off the screen
+   */
+  char ILI9341_DrawGradientRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c0, uint16_t c1, bool horizontal);
+
+  /**
+   * @desc    Draws a 1 bit per pixel bitmap without scaling, expanded to pixels as it is streamed so no
+   *          w*h*2 byte buffer is needed. Bit n of the bitmap (byte n/8, least significant bit first)
+   *          is the pixel y*w+x.
+   *
+   * @param   uint16_t x The starting X coordinate
+   * @param   uint16_t y The starting Y coordinate
+   * @param   uint8_t* bitmap The buffer of the bitmap being read from
+   * @param   uint16_t w The width of the bitmap
+   * @param   uint16_t h The height of the bitmap
+   * @param   fg The foreground color (drawn if the corresponding bit is set)
+   * @param   bg The background color (drawn if the corresponding bit is not set)
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if the rectangle is empty or off the screen
+   */
+  char ILI9341_DrawBitmap(uint16_t x, uint16_t y, const uint8_t* bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565);
+
+  /**
+   * @desc    Identical to ILI9341_DrawBitmap except that the bitmap stores data in column-major order,
+   *          bit n is the pixel x*h+y
+   *
+   * @param   uint16_t x The starting X coordinate
+   * @param   uint16_t y The starting Y coordinate
+   * @param   uint8_t* bitmap The buffer of the bitmap being read from
+   * @param   uint16_t w The width of the bitmap
+   * @param   uint16_t h The height of the bitmap
+   * @param   fg The foreground color (drawn if the corresponding bit is set)
+   * @param   bg The background color (drawn if the corresponding bit is not set)
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if the rectangle is empty or off the screen
+   */
+  char ILI9341_DrawBitmapColMajor(uint16_t x, uint16_t y, const uint8_t* bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565);
+
+  /**
+   * @desc    Draws a 1 bit per pixel bitmap scaled to w x h by nearest neighbour, as ILI9341_RenderScaledBitmap
+   *          but rendered chunk by chunk into the stream buffers and sent with a single window and RAMWR,
+   *          so no dst_w*dst_h*2 byte buffer is needed (115200 bytes for 240x240)
+   *
+   * @param   uint16_t x The starting X coordinate
+   * @param   uint16_t y The starting Y coordinate
+   * @param   uint16_t w The width of the destination rectangle
+   * @param   uint16_t h The height of the destination rectangle
+   * @param   uint8_t* bitmap The buffer of the bitmap being read from, row-major as in ILI9341_DrawBitmap
+   * @param   uint16_t src_w The width of the bitmap
+   * @param   uint16_t src_h The height of the bitmap
+   * @param   fg The foreground color (drawn if the corresponding bit is set)
+   * @param   bg The background color (drawn if the corresponding bit is not set)
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if the rectangle is empty or off the screen
+   */
+  char ILI9341_DrawScaledBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t* bitmap, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565);
+
+  /**
+   * @desc    Identical to ILI9341_DrawScaledBitmap except that the bitmap stores data in column-major order
+   *
+   * @param   uint16_t x The starting X coordinate
+   * @param   uint16_t y The starting Y coordinate
+   * @param   uint16_t w The width of the destination rectangle
+   * @param   uint16_t h The height of the destination rectangle
+   * @param   uint8_t* bitmap The buffer of the bitmap being read from, column-major as in ILI9341_DrawBitmapColMajor
+   * @param   uint16_t src_w The width of the bitmap
+   * @param   uint16_t src_h The height of the bitmap
+   * @param   fg The foreground color (drawn if the corresponding bit is set)
+   * @param   bg The background color (drawn if the corresponding bit is not set)
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if the rectangle is empty or off the screen
+   */
+  char ILI9341_DrawScaledBitmapColMajor(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t* bitmap, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565);
+
+#ifdef ILI9341_FRAMEBUFFER
+  /**
+   * @desc    Redirects drawing into an off-screen framebuffer of ILI9341_FB_SIZE bytes, NULL draws to the
+   *          panel again. The buffer is used as is, clear it (e.g. ILI9341_ClearScreen) before drawing.
+   *          Commands which are not pixel writes (inversion, MADCTL, ...) still go to the panel at once.
+   *
+   * @param   uint8_t* fb
+   *
+   * @return  void
+   */
+  void ILI9341_AttachFramebuffer (uint8_t *fb);
+
+  /**
+   * @desc    Redirects drawing into a strip buffer holding the full-width rows ys to ye, filled with bg first.
+   *          Pixels outside of the strip are dropped, damage inside of it is kept as one area, so
+   *          ILI9341_Flush() sends the strip with a single window and RAMWR. Detach with ILI9341_AttachFramebuffer(NULL).
+   *
+   * @param   uint8_t* strip ILI9341_STRIP_SIZE(ye - ys + 1) bytes
+   * @param   uint16_t ys
+   * @param   uint16_t ye
+   * @param   uint16_t bg
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if the rows are out of range
+   */
+  char ILI9341_AttachStrip (uint8_t *strip, uint16_t ys, uint16_t ye, uint16_t bg);
+
+  /**
+   * @desc    Sets the cost model damaged areas are merged by. Two areas are sent as their bounding box when
+   *          that costs no more than sending both, each area costing window_cost plus 2 per pixel. Raise it
+   *          where a new window is expensive next to pixel bytes (fast SPI with a slow D/C line, DMA setup),
+   *          lower it on slow buses where only the bytes count.
+   *
+   * @param   uint16_t window_cost wire byte times, 0 for ILI9341_WINDOW_COST
+   *
+   * @return  void
+   */
+  void ILI9341_SetWindowCost (uint16_t window_cost);
+
+  /**
+   * @desc    Sends the areas of the framebuffer damaged since the last flush, one window and RAMWR per area,
+   *          straight out of the framebuffer through sendbuf (sendbyte without it). The transfer may still be
+   *          in flight on return, the next drawing call waits for it.
+   *
+   * @param   void
+   *
+   * @return  void
+   */
+  void ILI9341_Flush (void);
+
+  /**
+   * @desc    Keeps a copy of the frame on the panel. Flushes then compare the damaged areas against it row by row
+   *          and send only the spans that changed, each with a minimal window (spans closer than a window cost
+   *          are joined, see ILI9341_SetWindowCost), and copy what they sent into it. The copy has to match the
+   *          panel when it is attached, e.g. memcpy the framebuffer into it after a full flush. NULL sends the
+   *          damaged areas whole again.
+   *
+   * @param   uint8_t* prev ILI9341_FB_SIZE bytes
+   *
+   * @return  void
+   */
+  void ILI9341_AttachPrevFrame (uint8_t *prev);
+#endif
+
+  // PER-INSTANCE API
+  // ---------------------------------------------------------------
+  // Same behavior as the ILI9341_* function of the same name, on the given instance
+
+  /** @desc Instance variant of ILI9341_SetData */
+  void ili9341_set_data (ili9341_t *lcd);
+
+  /** @desc Instance variant of ILI9341_Barrier */
+  void ili9341_barrier (ili9341_t *lcd);
+
+  /** @desc Instance variant of ILI9341_Init */
+  void ili9341_init (ili9341_t *lcd);
+
+  /** @desc Instance variant of ILI9341_InitStart */
+  void ili9341_init_start (ili9341_t *lcd, ILI9341_Boot profile);
+
+  /** @desc Instance variant of ILI9341_InitStep */
+  uint32_t ili9341_init_step (ili9341_t *lcd);
+
+  /** @desc Instance variant of ILI9341_HWReset */
+  void ili9341_hw_reset (ili9341_t *lcd);
+
+  /** @desc Instance variant of ILI9341_InvalidateShadow */
+  void ili9341_invalidate_shadow (ili9341_t *lcd);
+
+  /** @desc Instance variant of ILI9341_TransmitCmmd */
+  void ili9341_transmit_cmmd (ili9341_t *lcd, uint8_t cmmd);
+
+  /** @desc Instance variant of ILI9341_Transmit8bitData */
+  void ili9341_transmit_8bit_data (ili9341_t *lcd, uint8_t data);
+
+  /** @desc Instance variant of ILI9341_Transmit16bitData */
+  void ili9341_transmit_16bit_data (ili9341_t *lcd, uint16_t data);
+
+  /** @desc Instance variant of ILI9341_Transmit32bitData */
+  void ili9341_transmit_32bit_data (ili9341_t *lcd, uint32_t data);
+
+  /** @desc Instance variant of ILI9341_SetWindow */
+  char ili9341_set_window (ili9341_t *lcd, uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye);
+
+  /** @desc Instance variant of ILI9341_DrawRect */
+  char ili9341_draw_rect (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+
+  /** @desc Instance variant of ILI9341_DrawPixel */
+  char ili9341_draw_pixel (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t color);
+
+  /** @desc Instance variant of ILI9341_SendColor565 */
+  void ili9341_send_color565 (ili9341_t *lcd, uint16_t color, uint32_t count);
+
+  /** @desc Instance variant of ILI9341_ClearScreen */
+  void ili9341_clear_screen (ili9341_t *lcd, uint32_t color);
+
+  /** @desc Instance variant of ILI9341_WritePatternRect */
+  void ili9341_write_pattern_rect (ili9341_t *lcd, uint8_t *pattern_buf, uint16_t len, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+  /** @desc Instance variant of ILI9341_StreamRect */
+  char ili9341_stream_rect (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, ili9341_render_fn render, void *arg);
+
+  /** @desc Instance variant of ILI9341_DrawGradientRect */
+  char ili9341_draw_gradient_rect (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c0, uint16_t c1, bool horizontal);
+
+  /** @desc Instance variant of ILI9341_DrawBitmap */
+  char ili9341_draw_bitmap (ili9341_t *lcd, uint16_t x, uint16_t y, const uint8_t *bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565);
+
+  /** @desc Instance variant of ILI9341_DrawBitmapColMajor */
+  char ili9341_draw_bitmap_col_major (ili9341_t *lcd, uint16_t x, uint16_t y, const uint8_t *bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565);
+
+  /** @desc Instance variant of ILI9341_DrawScaledBitmap */
+  char ili9341_draw_scaled_bitmap (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *bitmap, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565);
+
+  /** @desc Instance variant of ILI9341_DrawScaledBitmapColMajor */
+  char ili9341_draw_scaled_bitmap_col_major (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *bitmap, uint16_t src_w, uint16_t src_h, uint16_t fg565, uint16_t bg565);
+
+#ifdef ILI9341_FRAMEBUFFER
+  /** @desc Instance variant of ILI9341_AttachFramebuffer */
+  void ili9341_attach_framebuffer (ili9341_t *lcd, uint8_t *fb);
+
+  /** @desc Instance variant of ILI9341_AttachStrip */
+  char ili9341_attach_strip (ili9341_t *lcd, uint8_t *strip, uint16_t ys, uint16_t ye, uint16_t bg);
+
+  /** @desc Instance variant of ILI9341_SetWindowCost */
+  void ili9341_set_window_cost (ili9341_t *lcd, uint16_t window_cost);
+
+  /** @desc Instance variant of ILI9341_Flush */
+  void ili9341_flush (ili9341_t *lcd);
+
+  /** @desc Instance variant of ILI9341_AttachPrevFrame */
+  void ili9341_attach_prev_frame (ili9341_t *lcd, uint8_t *prev);
+#endif
+
+  /** @desc Instance variant of ILI9341_InverseScreen */
+  void ili9341_inverse_screen (ili9341_t *lcd);
+
+  /** @desc Instance variant of ILI9341_NormalScreen */
+  void ili9341_normal_screen (ili9341_t *lcd);
+
+  /** @desc Instance variant of ILI9341_SetMemoryAccess */
+  void ili9341_set_memory_access (ili9341_t *lcd, uint8_t madctl);
+
+  /** @desc Instance variant of ILI9341_SetPixelFormat */
+  void ili9341_set_pixel_format (ili9341_t *lcd, uint8_t colmod);
+
+  /** @desc Instance variant of ILI9341_SetScrollArea */
+  char ili9341_set_scroll_area (ili9341_t *lcd, uint16_t top, uint16_t bottom);
+
+  /** @desc Instance variant of ILI9341_Scroll */
+  void ili9341_scroll (ili9341_t *lcd, int16_t lines);
+
+  /** @desc Instance variant of ILI9341_UpdateScreen */
+  void ili9341_update_screen (ili9341_t *lcd);
+
+  /** @desc Instance variant of ILI9341_DrawLine */
+  void ili9341_draw_line (ili9341_t *lcd, uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, uint16_t color);
+
+  /** @desc Instance variant of ILI9341_DrawLineHorizontal */
+  char ili9341_draw_line_horizontal (ili9341_t *lcd, uint16_t xs, uint16_t xe, uint16_t y, uint16_t color);
+
+  /** @desc Instance variant of ILI9341_DrawLineVertical */
+  char ili9341_draw_line_vertical (ili9341_t *lcd, uint16_t x, uint16_t ys, uint16_t ye, uint16_t color);
+
+  /** @desc Instance variant of ILI9341_DrawCharFast */
+  char ili9341_draw_char_fast (ili9341_t *lcd, char character, uint16_t text_color, uint8_t text_scale, uint16_t bg_color);
+
+  /** @desc Instance variant of ILI9341_AttachGlyphCache */
+  char ili9341_attach_glyph_cache (ili9341_t *lcd, uint8_t *pool, uint32_t len, uint8_t max_scale);
+
+  /** @desc Instance variant of ILI9341_GlyphCacheStats */
+  void ili9341_glyph_cache_stats (const ili9341_t *lcd, uint32_t *hits, uint32_t *misses);
+
+  /** @desc Instance variant of ILI9341_DrawChar */
+  char ili9341_draw_char (ili9341_t *lcd, char character, uint16_t color, ILI9341_Sizes size);
+
+  /** @desc Instance variant of ILI9341_DrawStringFast */
+  void ili9341_draw_string_fast (ili9341_t *lcd, char *str, uint16_t text_color, uint8_t size, uint16_t bg_color);
+
+  /** @desc Instance variant of ILI9341_DrawString */
+  void ili9341_draw_string (ili9341_t *lcd, char *str, uint16_t color, ILI9341_Sizes size);
+
+  /** @desc Instance variant of ILI9341_CheckPosition */
+  char ili9341_check_position (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t max_y, ILI9341_Sizes size);
+
+  /** @desc Instance variant of ILI9341_SetPosition */
+  char ili9341_set_position (ili9341_t *lcd, uint16_t x, uint16_t y);
+
 #endif
@@ -0,0 +1,179 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        ILI9341 scrolling text console
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_console.c
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341, font
+ * ---------------------------------------------------------------+
+ */
+
+#include <stdio.h>
+#include "font.h"
+#include "ili9341_console.h"
+
+/**
+ * @desc    Height of a text line in rows
+ *
+ * @param   const ili9341_console_t* con
+ *
+ * @return  uint16_t
+ */
+static uint16_t consoleLineHeight(const ili9341_console_t *con)
+{
+  return CHARS_ROWS_LENGTH * con->scale;
+}
+
+/**
+ * @desc    Width of a character cell in columns, 5 columns and one spacing column
+ *
+ * @param   const ili9341_console_t* con
+ *
+ * @return  uint16_t
+ */
+static uint16_t consoleCellWidth(const ili9341_console_t *con)
+{
+  return (CHARS_COLS_LENGTH + 1) * con->scale;
+}
+
+/**
+ * @desc    Puts the cursor at a pixel column of the cursor line
+ *
+ * @param   ili9341_console_t* con
+ * @param   uint16_t x
+ *
+ * @return  void
+ */
+static void consoleCursor(ili9341_console_t *con, uint16_t x)
+{
+  ili9341_set_position(con->lcd, x, con->top + con->line * consoleLineHeight(con));
+}
+
+/**
+ * @desc    Moves the cursor to the start of the next line. Past the last line the console scrolls
+ *          up by a line, and the line coming in at the bottom is cleared.
+ *
+ * @param   ili9341_console_t* con
+ *
+ * @return  void
+ */
+static void consoleNewline(ili9341_console_t *con)
+{
+  if (con->line + 1 < con->lines) {
+    con->line++;
+    consoleCursor(con, 0);
+    return;
+  }
+  ili9341_scroll(con->lcd, consoleLineHeight(con));
+  consoleCursor(con, 0);
+  ili9341_console_clear_eol(con);
+}
+
+char ili9341_console_init (ili9341_console_t *con, ili9341_t *lcd, uint16_t top, uint16_t bottom, uint8_t scale, uint16_t fg, uint16_t bg)
+{
+  if (scale == 0 || (uint32_t) top + bottom + CHARS_ROWS_LENGTH * scale > ILI9341_MAX_Y) {
+    return ILI9341_ERROR;
+  }
+  con->lcd = lcd;
+  con->top = top;
+  con->scale = scale;
+  con->fg = fg;
+  con->bg = bg;
+  con->lines = (ILI9341_MAX_Y - top - bottom) / consoleLineHeight(con);
+  ili9341_console_clear(con);
+
+  return ILI9341_SUCCESS;
+}
+
+void ili9341_console_putc (ili9341_console_t *con, char c)
+{
+  uint16_t cw = consoleCellWidth(con);
+
+  switch (c) {
+    case '\n':
+      consoleNewline(con);
+      return;
+    case '\r':
+      consoleCursor(con, 0);
+      return;
+    case '\t':
+      do {
+        ili9341_console_putc(con, ' ');
+      } while ((con->lcd->cache_index_col / cw) % ILI9341_CONSOLE_TAB);
+      return;
+    case '\b':
+      if (con->lcd->cache_index_col >= cw) {
+        consoleCursor(con, con->lcd->cache_index_col - cw);
+      }
+      return;
+  }
+  // no glyph
+  if ((uint8_t) c < 0x20 || ((uint8_t) c >= 0x80 && (uint8_t) c < 0xc0)) {
+    return;
+  }
+  // a UTF-8 sequence takes one cell from its lead byte on, the font only has ASCII
+  if ((uint8_t) c >= 0xc0) {
+    c = ILI9341_FALLBACK_CHAR;
+  }
+  // wrap before a cell that does not fit any more
+  if (con->lcd->cache_index_col + cw > ILI9341_MAX_X) {
+    consoleNewline(con);
+  }
+  ili9341_draw_char_fast(con->lcd, c, con->fg, con->scale, con->bg);
+}
+
+void ili9341_console_puts (ili9341_console_t *con, const char *str)
+{
+  while (*str) {
+    ili9341_console_putc(con, *str++);
+  }
+}
+
+int ili9341_console_printf (ili9341_console_t *con, const char *fmt, ...)
+{
+  char buf[ILI9341_CONSOLE_PRINTF_LEN];
+  va_list args;
+  int len;
+
+  va_start(args, fmt);
+  len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  ili9341_console_puts(con, buf);
+
+  return len;
+}
+
+void ili9341_console_clear_eol (ili9341_console_t *con)
+{
+  uint16_t x = con->lcd->cache_index_col;
+
+  if (x < ILI9341_MAX_X) {
+    ili9341_draw_rect(con->lcd, x, con->lcd->cache_index_row, ILI9341_MAX_X - x, consoleLineHeight(con), con->bg);
+  }
+}
+
+void ili9341_console_clear (ili9341_console_t *con)
+{
+  uint16_t rows = con->lines * consoleLineHeight(con);
+
+  // rows below the last full line stay fixed
+  ili9341_set_scroll_area(con->lcd, con->top, ILI9341_MAX_Y - con->top - rows);
+  ili9341_draw_rect(con->lcd, 0, con->top, ILI9341_MAX_X, rows, con->bg);
+  con->line = 0;
+  consoleCursor(con, 0);
+}
+
+char ili9341_console_goto (ili9341_console_t *con, uint16_t col, uint16_t line)
+{
+  uint16_t x = col * consoleCellWidth(con);
+
+  if (line >= con->lines || x >= ILI9341_MAX_X) {
+    return ILI9341_ERROR;
+  }
+  con->line = line;
+  consoleCursor(con, x);
+
+  return ILI9341_SUCCESS;
+}
@@ -0,0 +1,124 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        ILI9341 scrolling text console
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_console.h
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341, font
+ * ---------------------------------------------------------------+
+ *
+ * Terminal-style text output into the rows between a fixed top and bottom
+ * area: characters are drawn with ili9341_draw_char_fast at the text cursor
+ * of the driver instance, lines wrap at the right edge, and a new line past
+ * the last one scrolls the area with the vertical scroll registers (VSSAD)
+ * instead of redrawing it. Only the line coming in at the bottom is cleared.
+ *
+ * The console owns the scroll area of the panel and shares the text cursor
+ * (ili9341_set_position) of the instance, text drawn elsewhere moves it.
+ */
+
+#ifndef __ILI9341_CONSOLE_H__
+#define __ILI9341_CONSOLE_H__
+
+#include <stdint.h>
+#include <stdarg.h>
+#include "ili9341.h"
+
+  // Longest text ili9341_console_printf() writes, the rest is cut off
+  #ifndef ILI9341_CONSOLE_PRINTF_LEN
+    #define ILI9341_CONSOLE_PRINTF_LEN  64
+  #endif
+
+  // Columns of a tab stop
+  #define ILI9341_CONSOLE_TAB           8
+
+  /** @struct Console of one panel, members are private to the console */
+  typedef struct {
+    ili9341_t *lcd;
+    uint16_t top;           // first screen row of the console
+    uint16_t lines;         // text lines of the console
+    uint16_t line;          // text line of the cursor
+    uint8_t scale;          // text scale, cells are 6x8 * scale
+    uint16_t fg, bg;
+  } ili9341_console_t;
+
+  /**
+   * @desc    Prepares a console on the rows between the fixed top and bottom areas, clears it and puts
+   *          the cursor home. Rows left over below the last full text line join the bottom area.
+   *
+   * @param   ili9341_console_t* con
+   * @param   ili9341_t* lcd
+   * @param   uint16_t top fixed rows above the console
+   * @param   uint16_t bottom fixed rows below the console
+   * @param   uint8_t scale text scale
+   * @param   uint16_t fg text color
+   * @param   uint16_t bg background color
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if not a single text line fits
+   */
+  char ili9341_console_init (ili9341_console_t *con, ili9341_t *lcd, uint16_t top, uint16_t bottom, uint8_t scale, uint16_t fg, uint16_t bg);
+
+  /**
+   * @desc    Writes a character at the cursor. Understands '\n' (new line), '\r' (back to the first column),
+   *          '\t' (next tab stop) and '\b' (one column back); other control characters are ignored.
+   *          Text is UTF-8, a non-ASCII character is drawn as ILI9341_FALLBACK_CHAR in one cell.
+   *
+   * @param   ili9341_console_t* con
+   * @param   char c
+   *
+   * @return  void
+   */
+  void ili9341_console_putc (ili9341_console_t *con, char c);
+
+  /**
+   * @desc    Writes a string at the cursor
+   *
+   * @param   ili9341_console_t* con
+   * @param   const char* str
+   *
+   * @return  void
+   */
+  void ili9341_console_puts (ili9341_console_t *con, const char *str);
+
+  /**
+   * @desc    Writes formatted text at the cursor, up to ILI9341_CONSOLE_PRINTF_LEN - 1 characters
+   *
+   * @param   ili9341_console_t* con
+   * @param   const char* fmt printf format
+   *
+   * @return  int characters of the whole formatted text, as vsnprintf
+   */
+  int ili9341_console_printf (ili9341_console_t *con, const char *fmt, ...);
+
+  /**
+   * @desc    Clears from the cursor to the end of its line, the cursor stays
+   *
+   * @param   ili9341_console_t* con
+   *
+   * @return  void
+   */
+  void ili9341_console_clear_eol (ili9341_console_t *con);
+
+  /**
+   * @desc    Clears the console, resets the scroll position and puts the cursor home
+   *
+   * @param   ili9341_console_t* con
+   *
+   * @return  void
+   */
+  void ili9341_console_clear (ili9341_console_t *con);
+
+  /**
+   * @desc    Moves the cursor
+   *
+   * @param   ili9341_console_t* con
+   * @param   uint16_t col column, from 0
+   * @param   uint16_t line text line, from 0
+   *
+   * @return  char ILI9341_ERROR if out of the console
+   */
+  char ili9341_console_goto (ili9341_console_t *con, uint16_t col, uint16_t line);
+
+#endif
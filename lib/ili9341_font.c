@@ -0,0 +1,239 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        ILI9341 proportional fonts
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_font.c
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341
+ * ---------------------------------------------------------------+
+ */
+
+#include <stdbool.h>
+#include "ili9341_font.h"
+
+/** @struct State of a glyph box being streamed */
+typedef struct {
+  const uint8_t *src;     // next byte of the bitmap
+  bool rle;
+  bool hi;                // RLE: next run is in the high nibble of src
+  uint8_t bpp;            // packed: bits per pixel
+  uint8_t bits;           // packed: byte being read, RLE: value of the run
+  uint8_t left;           // packed: bits of the byte not read, RLE: pixels of the run not read
+  uint16_t w;             // columns of the box
+  uint16_t cl, cr;        // visible columns, cl to cr-1
+  uint16_t col;           // column of the next pixel
+  uint8_t lut[16][2];     // colors on the wire by pixel value, background to text color
+} font_stream_t;
+
+/**
+ * @desc    Prepares the stream for the glyphs of a font: its encoding and the color table from pixel
+ *          value 0 (background) to the largest one (text color), blended per channel in between
+ *
+ * @param   font_stream_t* fs
+ * @param   const ili9341_font_t* font
+ * @param   uint16_t text_color
+ * @param   uint16_t bg_color
+ *
+ * @return  void
+ */
+static void fontStart(font_stream_t *fs, const ili9341_font_t *font, uint16_t text_color, uint16_t bg_color)
+{
+  int16_t max;
+  int16_t r0 = RGBR(bg_color), g0 = RGBG(bg_color), b0 = RGBB(bg_color);
+  int16_t dr = RGBR(text_color) - r0, dg = RGBG(text_color) - g0, db = RGBB(text_color) - b0;
+  uint16_t color;
+
+  fs->rle = font->flags & ILI9341_FONT_RLE;
+  fs->bpp = (font->flags & ILI9341_FONT_4BPP) ? 4 : (font->flags & ILI9341_FONT_2BPP) ? 2 : 1;
+  max = (1 << fs->bpp) - 1;
+  for (int16_t a=0; a<=max; a++) {
+    // rounded to the nearest level
+    uint8_t r = r0 + (dr*a + (dr < 0 ? -max : max)/2) / max;
+    uint8_t g = g0 + (dg*a + (dg < 0 ? -max : max)/2) / max;
+    uint8_t b = b0 + (db*a + (db < 0 ? -max : max)/2) / max;
+    color = ILI9341_RGB565(r, g, b);
+    ILI9341_RGB565_DECODETOBUF(fs->lut[a], color)
+  }
+}
+
+/**
+ * @desc    Reads the next pixel of the glyph bitmap
+ *
+ * @param   font_stream_t* fs
+ *
+ * @return  uint8_t 0 if clear, coverage of anti-aliased fonts, 1 if set otherwise
+ */
+static uint8_t fontPixel(font_stream_t *fs)
+{
+  if (fs->rle) {
+    // the next run has the other value, it may be empty
+    while (!fs->left) {
+      fs->bits = !fs->bits;
+      fs->left = fs->hi ? (*fs->src >> 4) : (*fs->src++ & 0x0f);
+      fs->hi = !fs->hi;
+    }
+    fs->left--;
+    return fs->bits;
+  }
+  if (!fs->left) {
+    fs->bits = *fs->src++;
+    fs->left = 8;
+  }
+  fs->left -= fs->bpp;
+  return (fs->bits >> fs->left) & ((1 << fs->bpp) - 1);
+}
+
+/**
+ * @desc    Renders the visible pixels of a glyph box, row by row, reading past the clipped columns
+ *
+ * @param   void* arg font_stream_t
+ * @param   uint8_t* buf
+ * @param   uint16_t len
+ *
+ * @return  void
+ */
+static void renderFont(void *arg, uint8_t *buf, uint16_t len)
+{
+  font_stream_t *fs = arg;
+
+  for (uint16_t i=0; i<len; i+=2) {
+    for (; fs->col < fs->cl; fs->col++) {
+      fontPixel(fs);
+    }
+    const uint8_t *px = fs->lut[fontPixel(fs)];
+    buf[i] = px[0];
+    buf[i+1] = px[1];
+    if (++fs->col == fs->cr) {
+      for (; fs->col < fs->w; fs->col++) {
+        fontPixel(fs);
+      }
+      fs->col = 0;
+    }
+  }
+}
+
+/**
+ * @desc    Draws the box of a glyph with its left edge at x and its top edge at y
+ *
+ * @param   ili9341_t* lcd
+ * @param   font_stream_t* fs prepared for the font
+ * @param   const uint8_t* bitmap of the glyph
+ * @param   const ili9341_font_glyph_t* g
+ * @param   int16_t x
+ * @param   int16_t y
+ *
+ * @return  void
+ */
+static void drawGlyph(ili9341_t *lcd, font_stream_t *fs, const uint8_t *bitmap, const ili9341_font_glyph_t *g, int16_t x, int16_t y)
+{
+  // visible part of the box
+  int16_t xs = (x < 0) ? 0 : x;
+  int16_t ys = (y < 0) ? 0 : y;
+  int16_t xe = (x + g->width > ILI9341_MAX_X) ? ILI9341_MAX_X : x + g->width;
+  int16_t ye = (y + g->height > (int16_t) ILI9341_MAX_Y) ? (int16_t) ILI9341_MAX_Y : y + g->height;
+
+  if (xs >= xe || ys >= ye) {
+    return;
+  }
+  fs->src = bitmap;
+  fs->left = 0;
+  // runs start with clear pixels
+  fs->hi = true;
+  fs->bits = 1;
+  fs->w = g->width;
+  fs->cl = xs - x;
+  fs->cr = xe - x;
+  fs->col = 0;
+  // rows clipped at the top
+  for (uint32_t skip = (uint32_t) (ys - y) * g->width; skip; skip--) {
+    fontPixel(fs);
+  }
+  ili9341_stream_rect(lcd, xs, ys, xe - xs, ye - ys, renderFont, fs);
+}
+
+/**
+ * @desc    Looks up the glyph of a codepoint, first in the run of the previous lookup
+ *
+ * @param   const ili9341_font_t* font
+ * @param   uint32_t codepoint
+ * @param   const ili9341_font_range_t** hint run of the previous lookup or NULL, updated
+ *
+ * @return  const ili9341_font_glyph_t* NULL if the font does not have it
+ */
+static const ili9341_font_glyph_t *fontFind(const ili9341_font_t *font, uint32_t codepoint, const ili9341_font_range_t **hint)
+{
+  const ili9341_font_range_t *r = *hint;
+  uint16_t lo = 0, hi = font->range_count;
+
+  // text mostly stays within one script
+  if (!r || codepoint < r->first || codepoint - r->first >= r->count) {
+    r = NULL;
+    while (lo < hi) {
+      uint16_t mid = lo + (hi - lo) / 2;
+      const ili9341_font_range_t *m = &font->ranges[mid];
+      if (codepoint < m->first) {
+        hi = mid;
+      } else if (codepoint - m->first >= m->count) {
+        lo = mid + 1;
+      } else {
+        r = m;
+        break;
+      }
+    }
+    if (!r) {
+      return NULL;
+    }
+    *hint = r;
+  }
+  return &font->glyphs[r->glyph + (codepoint - r->first)];
+}
+
+const ili9341_font_glyph_t *ili9341_font_glyph (const ili9341_font_t *font, uint32_t codepoint)
+{
+  const ili9341_font_range_t *hint = NULL;
+
+  return fontFind(font, codepoint, &hint);
+}
+
+void ili9341_draw_text (ili9341_t *lcd, const ili9341_font_t *font, const char *str, uint16_t text_color, uint16_t bg_color)
+{
+  const ili9341_font_range_t *hint = NULL;
+  const ili9341_font_glyph_t *g;
+  font_stream_t fs;
+
+  // blended once for the whole string
+  fontStart(&fs, font, text_color, bg_color);
+  while (*str) {
+    if (*str == '\n') {
+      lcd->cache_index_col = 0;
+      lcd->cache_index_row += font->line_height;
+      str++;
+      continue;
+    }
+    g = fontFind(font, ili9341_utf8_next(&str), &hint);
+    if (!g) {
+      g = &font->glyphs[font->fallback];
+    }
+    if (g->width && g->height) {
+      drawGlyph(lcd, &fs, font->bitmap + g->offset, g,
+        lcd->cache_index_col + g->x_offset,
+        lcd->cache_index_row + font->ascent + g->y_offset);
+    }
+    lcd->cache_index_col += g->advance;
+  }
+}
+
+uint16_t ili9341_text_width (const ili9341_font_t *font, const char *str)
+{
+  const ili9341_font_range_t *hint = NULL;
+  const ili9341_font_glyph_t *g;
+  uint16_t w = 0;
+
+  while (*str && *str != '\n') {
+    g = fontFind(font, ili9341_utf8_next(&str), &hint);
+    w += (g ? g : &font->glyphs[font->fallback])->advance;
+  }
+  return w;
+}
@@ -0,0 +1,107 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        ILI9341 proportional fonts
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_font.h
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341
+ * ---------------------------------------------------------------+
+ *
+ * Fonts with a width, advance and bounding box per glyph, generated as C
+ * arrays by host/fontconv from BDF fonts (or from the built-in 5x8 font).
+ * A font holds any set of Unicode codepoints: its glyphs are indexed by
+ * sorted runs of consecutive codepoints, so a glyph of a font with
+ * thousands of them is found in a few steps of a binary search.
+ * Only the pixels of a glyph's bounding box are stored, row after row,
+ * either packed 1 bit per pixel MSB first, run-length encoded, or as 2 or
+ * 4 bits of coverage for anti-aliased text.
+ *
+ * Text is drawn at the text cursor of the driver instance (see
+ * ili9341_set_position), which is the top left corner of the text line.
+ * Every glyph streams its bounding box alone, set pixels in the text color
+ * and the rest in the background color. Coverage levels of anti-aliased
+ * fonts are blended between the two once per string into a table of
+ * colors on the wire, the renderer looks every pixel up in it. The area
+ * between the boxes is not touched: clear it first (see
+ * ili9341_text_width) where other text was.
+ */
+
+#ifndef __ILI9341_FONT_H__
+#define __ILI9341_FONT_H__
+
+#include <stdint.h>
+#include "ili9341.h"
+
+  // Bitmaps are run-length encoded: 4-bit runs, high nibble first, alternate between clear and set
+  // pixels starting with clear ones. A run of 0 lets a run longer than 15 carry on.
+  #define ILI9341_FONT_RLE      0x01
+  // Anti-aliased bitmaps, packed 2 or 4 bits of coverage per pixel MSB first, not run-length encoded
+  #define ILI9341_FONT_2BPP     0x02
+  #define ILI9341_FONT_4BPP     0x04
+
+  /** @struct Glyph of a font */
+  typedef struct {
+    uint32_t offset;          // first byte of the glyph in the bitmap of the font
+    uint8_t width, height;    // bounding box
+    uint8_t advance;          // columns the cursor moves on
+    int8_t x_offset;          // left edge of the box from the cursor
+    int8_t y_offset;          // top edge of the box from the baseline, negative above it
+  } ili9341_font_glyph_t;
+
+  /** @struct Run of consecutive codepoints a font has, their glyphs consecutive as well */
+  typedef struct {
+    uint32_t first;           // codepoint of the first glyph
+    uint16_t count;           // codepoints first to first + count - 1
+    uint16_t glyph;           // index of the glyph of first
+  } ili9341_font_range_t;
+
+  /** @struct Font, a sparse set of Unicode codepoints */
+  typedef struct {
+    const uint8_t *bitmap;
+    const ili9341_font_glyph_t *glyphs;
+    const ili9341_font_range_t *ranges;   // sorted by codepoint, looked up by binary search
+    uint16_t range_count;
+    uint16_t fallback;        // index of the glyph drawn for codepoints the font does not have
+    uint8_t line_height;      // rows from one text line to the next
+    uint8_t ascent;           // rows from the top of a text line to the baseline
+    uint8_t flags;            // ILI9341_FONT_*
+  } ili9341_font_t;
+
+  /**
+   * @desc    Looks up the glyph of a codepoint
+   *
+   * @param   const ili9341_font_t* font
+   * @param   uint32_t codepoint
+   *
+   * @return  const ili9341_font_glyph_t* NULL if the font does not have it
+   */
+  const ili9341_font_glyph_t *ili9341_font_glyph (const ili9341_font_t *font, uint32_t codepoint);
+
+  /**
+   * @desc    Draws a UTF-8 string at the text cursor and moves the cursor past it. '\n' goes to the start
+   *          of the next text line, characters the font does not have (and malformed sequences) are drawn
+   *          with its fallback glyph. Glyphs are clipped at the edges of the screen.
+   *
+   * @param   ili9341_t* lcd
+   * @param   const ili9341_font_t* font
+   * @param   const char* str
+   * @param   uint16_t text_color
+   * @param   uint16_t bg_color
+   *
+   * @return  void
+   */
+  void ili9341_draw_text (ili9341_t *lcd, const ili9341_font_t *font, const char *str, uint16_t text_color, uint16_t bg_color);
+
+  /**
+   * @desc    Columns the cursor moves on over the first text line of a UTF-8 string
+   *
+   * @param   const ili9341_font_t* font
+   * @param   const char* str
+   *
+   * @return  uint16_t
+   */
+  uint16_t ili9341_text_width (const ili9341_font_t *font, const char *str);
+
+#endif
@@ -0,0 +1,506 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        ILI9341 pixel format conversions
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_pixel.c
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341
+ * ---------------------------------------------------------------+
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "ili9341_pixel.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  #define PIXEL_X86
+  #include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+  #define PIXEL_NEON
+  #include <arm_neon.h>
+#endif
+
+/** @struct Kernels of a set */
+typedef struct {
+  void (*expand_1bpp)(uint8_t *dst, const uint8_t *src, uint32_t count, const uint8_t fg[2], const uint8_t bg[2]);
+  void (*swap_565)(uint8_t *dst, const uint16_t *src, uint32_t count);
+  void (*pack_rgb888)(uint8_t *dst, const uint8_t *src, uint32_t count);
+  void (*pack_argb8888)(uint8_t *dst, const uint32_t *src, uint32_t count);
+} pixel_kernels_t;
+
+// PORTABLE C
+// ---------------------------------------------------------------
+
+/**
+ * @desc    Expands bits to pixels, long runs through a table of the 4 pixels of every nibble value
+ *
+ * @param   uint8_t* dst
+ * @param   const uint8_t* src
+ * @param   uint32_t count
+ * @param   const uint8_t* fg color on the wire
+ * @param   const uint8_t* bg color on the wire
+ *
+ * @return  void
+ */
+static void expand1bppC(uint8_t *dst, const uint8_t *src, uint32_t count, const uint8_t fg[2], const uint8_t bg[2])
+{
+  uint8_t lut[16][8];
+
+  // filling the table costs as much as 64 pixels, short runs (small stream buffers) go bit by bit
+  if (count < 128) {
+    for (uint32_t i = 0; i < count; i++, dst += 2) {
+      memcpy(dst, ((src[i >> 3] >> (i & 7)) & 1) ? fg : bg, 2);
+    }
+    return;
+  }
+  for (uint8_t n = 0; n < 16; n++) {
+    for (uint8_t b = 0; b < 4; b++) {
+      memcpy(&lut[n][2*b], (n & (1 << b)) ? fg : bg, 2);
+    }
+  }
+  for (; count >= 8; count -= 8) {
+    memcpy(dst, lut[*src & 0x0f], 8);
+    memcpy(dst + 8, lut[*src++ >> 4], 8);
+    dst += 16;
+  }
+  // bits of a last partial byte
+  expand1bppC(dst, src, count, fg, bg);
+}
+
+static void swap565C(uint8_t *dst, const uint16_t *src, uint32_t count)
+{
+  while (count--) {
+    *dst++ = *src >> 8;
+    *dst++ = *src++ & 0xff;
+  }
+}
+
+/**
+ * @desc    Packs a pixel, 5 bits of red, 6 of green and 5 of blue
+ *
+ * @param   uint8_t* dst
+ * @param   uint8_t r
+ * @param   uint8_t g
+ * @param   uint8_t b
+ *
+ * @return  void
+ */
+static void pack565(uint8_t *dst, uint8_t r, uint8_t g, uint8_t b)
+{
+  dst[0] = (r & 0xf8) | (g >> 5);
+  dst[1] = ((g & 0x1c) << 3) | (b >> 3);
+}
+
+static void packRgb888C(uint8_t *dst, const uint8_t *src, uint32_t count)
+{
+  for (; count; count--, src += 3, dst += 2) {
+    pack565(dst, src[0], src[1], src[2]);
+  }
+}
+
+static void packArgb8888C(uint8_t *dst, const uint32_t *src, uint32_t count)
+{
+  for (; count; count--, src++, dst += 2) {
+    pack565(dst, *src >> 16, *src >> 8, *src);
+  }
+}
+
+/** @var Portable kernels, the reference */
+static const pixel_kernels_t kernels_c = {
+  expand1bppC, swap565C, packRgb888C, packArgb8888C
+};
+
+#ifdef PIXEL_X86
+// SSE2, AVX2
+// ---------------------------------------------------------------
+
+/**
+ * @desc    Expands 8 pixels a byte: the byte in every 16-bit lane, compared with the bit of the lane
+ *
+ * @param   uint8_t* dst
+ * @param   const uint8_t* src
+ * @param   uint32_t count
+ * @param   const uint8_t* fg
+ * @param   const uint8_t* bg
+ *
+ * @return  void
+ */
+static void expand1bppSse2(uint8_t *dst, const uint8_t *src, uint32_t count, const uint8_t fg[2], const uint8_t bg[2])
+{
+  uint16_t fgw, bgw;
+  __m128i bits = _mm_setr_epi16(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+  __m128i fgv, bgv;
+
+  // lanes hold the wire bytes in memory order
+  memcpy(&fgw, fg, 2);
+  memcpy(&bgw, bg, 2);
+  fgv = _mm_set1_epi16(fgw);
+  bgv = _mm_set1_epi16(bgw);
+  for (; count >= 8; count -= 8) {
+    __m128i set = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(*src++), bits), bits);
+    _mm_storeu_si128((__m128i *) dst, _mm_or_si128(_mm_and_si128(set, fgv), _mm_andnot_si128(set, bgv)));
+    dst += 16;
+  }
+  expand1bppC(dst, src, count, fg, bg);
+}
+
+static void swap565Sse2(uint8_t *dst, const uint16_t *src, uint32_t count)
+{
+  for (; count >= 8; count -= 8, src += 8, dst += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *) src);
+    _mm_storeu_si128((__m128i *) dst, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+  }
+  swap565C(dst, src, count);
+}
+
+/**
+ * @desc    Packs 4 pixels 0x..RRGGBB into 565 in the low half of their 32-bit lanes, sign-extended
+ *          so that _mm_packs_epi32 keeps them
+ *
+ * @param   __m128i v
+ *
+ * @return  __m128i
+ */
+static __m128i pack565x4Sse2(__m128i v)
+{
+  __m128i r = _mm_and_si128(_mm_srli_epi32(v, 8), _mm_set1_epi32(0xf800));
+  __m128i g = _mm_and_si128(_mm_srli_epi32(v, 5), _mm_set1_epi32(0x07e0));
+  __m128i b = _mm_and_si128(_mm_srli_epi32(v, 3), _mm_set1_epi32(0x001f));
+
+  return _mm_srai_epi32(_mm_slli_epi32(_mm_or_si128(_mm_or_si128(r, g), b), 16), 16);
+}
+
+static void packArgb8888Sse2(uint8_t *dst, const uint32_t *src, uint32_t count)
+{
+  for (; count >= 8; count -= 8, src += 8, dst += 16) {
+    __m128i lo = pack565x4Sse2(_mm_loadu_si128((const __m128i *) src));
+    __m128i hi = pack565x4Sse2(_mm_loadu_si128((const __m128i *) (src + 4)));
+    __m128i v = _mm_packs_epi32(lo, hi);
+    _mm_storeu_si128((__m128i *) dst, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+  }
+  packArgb8888C(dst, src, count);
+}
+
+/** @var SSE2 kernels, RGB888 needs a byte shuffle SSE2 does not have */
+static const pixel_kernels_t kernels_sse2 = {
+  expand1bppSse2, swap565Sse2, packRgb888C, packArgb8888Sse2
+};
+
+__attribute__((target("avx2")))
+static void expand1bppAvx2(uint8_t *dst, const uint8_t *src, uint32_t count, const uint8_t fg[2], const uint8_t bg[2])
+{
+  uint16_t fgw, bgw;
+  __m256i bits = _mm256_setr_epi16(0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+                                   0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, (short) 0x8000);
+  __m256i fgv, bgv;
+
+  memcpy(&fgw, fg, 2);
+  memcpy(&bgw, bg, 2);
+  fgv = _mm256_set1_epi16(fgw);
+  bgv = _mm256_set1_epi16(bgw);
+  // 16 pixels of two bytes, the first one in the low 8 lanes
+  for (; count >= 16; count -= 16, src += 2, dst += 32) {
+    __m256i set = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16(src[0] | src[1] << 8), bits), bits);
+    _mm256_storeu_si256((__m256i *) dst, _mm256_blendv_epi8(bgv, fgv, set));
+  }
+  expand1bppSse2(dst, src, count, fg, bg);
+}
+
+__attribute__((target("avx2")))
+static void swap565Avx2(uint8_t *dst, const uint16_t *src, uint32_t count)
+{
+  for (; count >= 16; count -= 16, src += 16, dst += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) src);
+    _mm256_storeu_si256((__m256i *) dst, _mm256_or_si256(_mm256_slli_epi16(v, 8), _mm256_srli_epi16(v, 8)));
+  }
+  swap565Sse2(dst, src, count);
+}
+
+/**
+ * @desc    Packs 16 pixels of two vectors of 0x..RRGGBB lanes into 565 in wire order
+ *
+ * @param   __m256i lo first 8 pixels
+ * @param   __m256i hi next 8 pixels
+ *
+ * @return  __m256i
+ */
+__attribute__((target("avx2")))
+static __m256i pack565x16Avx2(__m256i lo, __m256i hi)
+{
+  __m256i v[2] = { lo, hi };
+
+  for (int i = 0; i < 2; i++) {
+    __m256i r = _mm256_and_si256(_mm256_srli_epi32(v[i], 8), _mm256_set1_epi32(0xf800));
+    __m256i g = _mm256_and_si256(_mm256_srli_epi32(v[i], 5), _mm256_set1_epi32(0x07e0));
+    __m256i b = _mm256_and_si256(_mm256_srli_epi32(v[i], 3), _mm256_set1_epi32(0x001f));
+    v[i] = _mm256_srai_epi32(_mm256_slli_epi32(_mm256_or_si256(_mm256_or_si256(r, g), b), 16), 16);
+  }
+  // packs works within 128-bit halves, the permute puts the pixels back in order
+  lo = _mm256_permute4x64_epi64(_mm256_packs_epi32(v[0], v[1]), 0xd8);
+  return _mm256_or_si256(_mm256_slli_epi16(lo, 8), _mm256_srli_epi16(lo, 8));
+}
+
+__attribute__((target("avx2")))
+static void packArgb8888Avx2(uint8_t *dst, const uint32_t *src, uint32_t count)
+{
+  for (; count >= 16; count -= 16, src += 16, dst += 32) {
+    _mm256_storeu_si256((__m256i *) dst, pack565x16Avx2(_mm256_loadu_si256((const __m256i *) src),
+                                                        _mm256_loadu_si256((const __m256i *) (src + 8))));
+  }
+  packArgb8888Sse2(dst, src, count);
+}
+
+/**
+ * @desc    Loads 8 RGB888 pixels as 0x00RRGGBB lanes, 4 from src and 4 from src + 12
+ *
+ * @param   const uint8_t* src 28 readable bytes
+ *
+ * @return  __m256i
+ */
+__attribute__((target("avx2")))
+static __m256i loadRgb888x8Avx2(const uint8_t *src)
+{
+  const __m256i shuf = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                                        2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+  __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) src)),
+                                      _mm_loadu_si128((const __m128i *) (src + 12)), 1);
+
+  return _mm256_shuffle_epi8(v, shuf);
+}
+
+__attribute__((target("avx2")))
+static void packRgb888Avx2(uint8_t *dst, const uint8_t *src, uint32_t count)
+{
+  // 16 pixels are 48 bytes, the last load reads 4 more
+  for (; count >= 18; count -= 16, src += 48, dst += 32) {
+    _mm256_storeu_si256((__m256i *) dst, pack565x16Avx2(loadRgb888x8Avx2(src), loadRgb888x8Avx2(src + 24)));
+  }
+  packRgb888C(dst, src, count);
+}
+
+/** @var AVX2 kernels */
+static const pixel_kernels_t kernels_avx2 = {
+  expand1bppAvx2, swap565Avx2, packRgb888Avx2, packArgb8888Avx2
+};
+#endif
+
+#ifdef PIXEL_NEON
+// NEON
+// ---------------------------------------------------------------
+
+static void expand1bppNeon(uint8_t *dst, const uint8_t *src, uint32_t count, const uint8_t fg[2], const uint8_t bg[2])
+{
+  static const uint16_t lane_bits[8] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+  uint16_t fgw, bgw;
+  uint16x8_t bits = vld1q_u16(lane_bits);
+  uint16x8_t fgv, bgv;
+
+  memcpy(&fgw, fg, 2);
+  memcpy(&bgw, bg, 2);
+  fgv = vdupq_n_u16(fgw);
+  bgv = vdupq_n_u16(bgw);
+  for (; count >= 8; count -= 8, dst += 16) {
+    uint16x8_t set = vtstq_u16(vdupq_n_u16(*src++), bits);
+    vst1q_u8(dst, vreinterpretq_u8_u16(vbslq_u16(set, fgv, bgv)));
+  }
+  expand1bppC(dst, src, count, fg, bg);
+}
+
+static void swap565Neon(uint8_t *dst, const uint16_t *src, uint32_t count)
+{
+  for (; count >= 8; count -= 8, src += 8, dst += 16) {
+    vst1q_u8(dst, vrev16q_u8(vreinterpretq_u8_u16(vld1q_u16(src))));
+  }
+  swap565C(dst, src, count);
+}
+
+/**
+ * @desc    Packs 16 pixels of deinterleaved channels and stores them interleaved in wire order
+ *
+ * @param   uint8_t* dst
+ * @param   uint8x16_t r
+ * @param   uint8x16_t g
+ * @param   uint8x16_t b
+ *
+ * @return  void
+ */
+static void pack565x16Neon(uint8_t *dst, uint8x16_t r, uint8x16_t g, uint8x16_t b)
+{
+  uint8x16x2_t px;
+
+  px.val[0] = vorrq_u8(vandq_u8(r, vdupq_n_u8(0xf8)), vshrq_n_u8(g, 5));
+  px.val[1] = vorrq_u8(vshlq_n_u8(vandq_u8(g, vdupq_n_u8(0x1c)), 3), vshrq_n_u8(b, 3));
+  vst2q_u8(dst, px);
+}
+
+static void packRgb888Neon(uint8_t *dst, const uint8_t *src, uint32_t count)
+{
+  for (; count >= 16; count -= 16, src += 48, dst += 32) {
+    uint8x16x3_t rgb = vld3q_u8(src);
+    pack565x16Neon(dst, rgb.val[0], rgb.val[1], rgb.val[2]);
+  }
+  packRgb888C(dst, src, count);
+}
+
+static void packArgb8888Neon(uint8_t *dst, const uint32_t *src, uint32_t count)
+{
+  // little-endian words are bytes B, G, R, A
+  for (; count >= 16; count -= 16, src += 16, dst += 32) {
+    uint8x16x4_t bgra = vld4q_u8((const uint8_t *) src);
+    pack565x16Neon(dst, bgra.val[2], bgra.val[1], bgra.val[0]);
+  }
+  packArgb8888C(dst, src, count);
+}
+
+/** @var NEON kernels */
+static const pixel_kernels_t kernels_neon = {
+  expand1bppNeon, swap565Neon, packRgb888Neon, packArgb8888Neon
+};
+#endif
+
+// SELECTION
+// ---------------------------------------------------------------
+
+/** @var Kernels of every set, NULL if not in this build */
+static const pixel_kernels_t *const kernel_sets[ILI9341_KERNELS_COUNT] = {
+  [ILI9341_KERNELS_C] = &kernels_c,
+#ifdef PIXEL_X86
+  [ILI9341_KERNELS_SSE2] = &kernels_sse2,
+  [ILI9341_KERNELS_AVX2] = &kernels_avx2,
+#endif
+#ifdef PIXEL_NEON
+  [ILI9341_KERNELS_NEON] = &kernels_neon,
+#endif
+};
+
+/** @var Set in use, picked on the first conversion */
+static const pixel_kernels_t *kernels;
+static ili9341_kernels_t kernels_set;
+
+bool ili9341_kernels_supported (ili9341_kernels_t set)
+{
+  if (set >= ILI9341_KERNELS_COUNT || !kernel_sets[set]) {
+    return false;
+  }
+#ifdef PIXEL_X86
+  if (set == ILI9341_KERNELS_AVX2) {
+    return __builtin_cpu_supports("avx2");
+  }
+#endif
+  return true;
+}
+
+char ili9341_use_kernels (ili9341_kernels_t set)
+{
+  if (!ili9341_kernels_supported(set)) {
+    return ILI9341_ERROR;
+  }
+  kernels = kernel_sets[set];
+  kernels_set = set;
+  return ILI9341_SUCCESS;
+}
+
+ili9341_kernels_t ili9341_kernels (void)
+{
+  if (!kernels) {
+    // the sets are in order of preference
+    ili9341_kernels_t set = ILI9341_KERNELS_COUNT;
+    while (ili9341_use_kernels(--set) != ILI9341_SUCCESS) {
+    }
+  }
+  return kernels_set;
+}
+
+const char *ili9341_kernels_name (ili9341_kernels_t set)
+{
+  static const char *const names[ILI9341_KERNELS_COUNT] = { "C", "SSE2", "AVX2", "NEON" };
+
+  return (set < ILI9341_KERNELS_COUNT) ? names[set] : "";
+}
+
+/**
+ * @desc    Kernels in use
+ *
+ * @param   void
+ *
+ * @return  const pixel_kernels_t*
+ */
+static const pixel_kernels_t *pixelKernels(void)
+{
+  if (!kernels) {
+    ili9341_kernels();
+  }
+  return kernels;
+}
+
+void ili9341_expand_1bpp (uint8_t *dst, const uint8_t *src, uint32_t count, uint16_t fg565, uint16_t bg565)
+{
+  uint8_t fg[2], bg[2];
+
+  ILI9341_RGB565_DECODETOBUF(fg, fg565)
+  ILI9341_RGB565_DECODETOBUF(bg, bg565)
+  pixelKernels()->expand_1bpp(dst, src, count, fg, bg);
+}
+
+void ili9341_swap_565 (uint8_t *dst, const uint16_t *src, uint32_t count)
+{
+  pixelKernels()->swap_565(dst, src, count);
+}
+
+void ili9341_pack_rgb888 (uint8_t *dst, const uint8_t *src, uint32_t count)
+{
+  pixelKernels()->pack_rgb888(dst, src, count);
+}
+
+void ili9341_pack_argb8888 (uint8_t *dst, const uint32_t *src, uint32_t count)
+{
+  pixelKernels()->pack_argb8888(dst, src, count);
+}
+
+// IMAGES
+// ---------------------------------------------------------------
+
+/** @struct State of an image being streamed */
+typedef struct {
+  const uint8_t *src;     // next pixel
+  ili9341_image_format_t format;
+} image_stream_t;
+
+/**
+ * @desc    Converts the next pixels of an image
+ *
+ * @param   void* arg image_stream_t
+ * @param   uint8_t* buf
+ * @param   uint16_t len
+ *
+ * @return  void
+ */
+static void renderImage(void *arg, uint8_t *buf, uint16_t len)
+{
+  image_stream_t *is = arg;
+  uint16_t n = len / 2;
+
+  switch (is->format) {
+    case ILI9341_IMAGE_RGB565:
+      pixelKernels()->swap_565(buf, (const uint16_t *) is->src, n);
+      is->src += n * 2;
+      break;
+    case ILI9341_IMAGE_RGB888:
+      pixelKernels()->pack_rgb888(buf, is->src, n);
+      is->src += n * 3;
+      break;
+    default:
+      pixelKernels()->pack_argb8888(buf, (const uint32_t *) is->src, n);
+      is->src += n * 4;
+      break;
+  }
+}
+
+char ili9341_draw_image (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const void *pixels, ili9341_image_format_t format)
+{
+  image_stream_t is = {.src=pixels, .format=format};
+
+  return ili9341_stream_rect(lcd, x, y, w, h, renderImage, &is);
+}
@@ -0,0 +1,139 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        ILI9341 pixel format conversions
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_pixel.h
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341
+ * ---------------------------------------------------------------+
+ *
+ * Conversions of pixel runs into RGB565 as it goes on the wire (big-endian):
+ * 1 bpp bitmaps, native 565, RGB888 and ARGB8888. Every conversion has a
+ * portable C kernel, the reference. Host builds for x86-64 add SSE2 and AVX2
+ * kernels and builds for little-endian ARMv8 NEON ones; the best set the CPU
+ * supports is picked at run time on the first call. The SIMD kernels write
+ * exactly the bytes of the C ones, host/bench_render checks that.
+ */
+
+#ifndef __ILI9341_PIXEL_H__
+#define __ILI9341_PIXEL_H__
+
+#include <stdint.h>
+#include "ili9341.h"
+
+  /** @enum Kernel sets of the conversions */
+  typedef enum {
+    ILI9341_KERNELS_C,        // portable C
+    ILI9341_KERNELS_SSE2,     // x86-64
+    ILI9341_KERNELS_AVX2,     // x86-64 with AVX2
+    ILI9341_KERNELS_NEON,     // ARMv8
+    ILI9341_KERNELS_COUNT
+  } ili9341_kernels_t;
+
+  /** @enum Layouts of the pixels drawn by ili9341_draw_image */
+  typedef enum {
+    ILI9341_IMAGE_RGB565,     // uint16_t in host byte order
+    ILI9341_IMAGE_RGB888,     // bytes R, G, B
+    ILI9341_IMAGE_ARGB8888    // uint32_t 0xAARRGGBB in host byte order, alpha ignored
+  } ili9341_image_format_t;
+
+  /**
+   * @desc    Kernel set in use, picking the best one the CPU supports on the first call
+   *
+   * @param   void
+   *
+   * @return  ili9341_kernels_t
+   */
+  ili9341_kernels_t ili9341_kernels (void);
+
+  /**
+   * @desc    Tells if the build and the CPU support a kernel set
+   *
+   * @param   ili9341_kernels_t set
+   *
+   * @return  bool
+   */
+  bool ili9341_kernels_supported (ili9341_kernels_t set);
+
+  /**
+   * @desc    Switches all conversions to a kernel set, e.g. to compare it with ILI9341_KERNELS_C
+   *
+   * @param   ili9341_kernels_t set
+   *
+   * @return  char ILI9341_SUCCESS, ILI9341_ERROR if the set is not supported
+   */
+  char ili9341_use_kernels (ili9341_kernels_t set);
+
+  /**
+   * @desc    Name of a kernel set
+   *
+   * @param   ili9341_kernels_t set
+   *
+   * @return  const char*
+   */
+  const char *ili9341_kernels_name (ili9341_kernels_t set);
+
+  /**
+   * @desc    Expands the bits of a 1 bpp bitmap to pixels, set bits in fg565 and the others in bg565
+   *
+   * @param   uint8_t* dst count * 2 bytes
+   * @param   const uint8_t* src bit 0 of the first byte first
+   * @param   uint32_t count pixels
+   * @param   uint16_t fg565
+   * @param   uint16_t bg565
+   *
+   * @return  void
+   */
+  void ili9341_expand_1bpp (uint8_t *dst, const uint8_t *src, uint32_t count, uint16_t fg565, uint16_t bg565);
+
+  /**
+   * @desc    Puts 565 pixels in host byte order into wire order
+   *
+   * @param   uint8_t* dst count * 2 bytes
+   * @param   const uint16_t* src
+   * @param   uint32_t count pixels
+   *
+   * @return  void
+   */
+  void ili9341_swap_565 (uint8_t *dst, const uint16_t *src, uint32_t count);
+
+  /**
+   * @desc    Packs RGB888 pixels into 565 in wire order, dropping the low bits of every channel
+   *
+   * @param   uint8_t* dst count * 2 bytes
+   * @param   const uint8_t* src bytes R, G, B of every pixel
+   * @param   uint32_t count pixels
+   *
+   * @return  void
+   */
+  void ili9341_pack_rgb888 (uint8_t *dst, const uint8_t *src, uint32_t count);
+
+  /**
+   * @desc    Packs ARGB8888 pixels into 565 in wire order as ili9341_pack_rgb888, alpha is ignored
+   *
+   * @param   uint8_t* dst count * 2 bytes
+   * @param   const uint32_t* src 0xAARRGGBB
+   * @param   uint32_t count pixels
+   *
+   * @return  void
+   */
+  void ili9341_pack_argb8888 (uint8_t *dst, const uint32_t *src, uint32_t count);
+
+  /**
+   * @desc    Draws an image, converted chunk by chunk into the stream buffers (see ili9341_stream_rect)
+   *
+   * @param   ili9341_t* lcd
+   * @param   uint16_t x
+   * @param   uint16_t y
+   * @param   uint16_t w
+   * @param   uint16_t h
+   * @param   const void* pixels w * h pixels, row after row
+   * @param   ili9341_image_format_t format
+   *
+   * @return  char
+   */
+  char ili9341_draw_image (ili9341_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const void *pixels, ili9341_image_format_t format);
+
+#endif
@@ -0,0 +1,423 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        ILI9341 asynchronous command queue
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_queue.c
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341
+ * ---------------------------------------------------------------+
+ */
+
+#include <string.h>
+#include "ili9341_queue.h"
+
+#if (ILI9341_QUEUE_LEN < 2) || (ILI9341_QUEUE_LEN > 128) || (ILI9341_QUEUE_LEN & (ILI9341_QUEUE_LEN - 1))
+  #error "ILI9341_QUEUE_LEN must be a power of two between 2 and 128"
+#endif
+
+#if defined(__GNUC__)
+  // the index store publishes the slot contents written before it
+  #define _Q_LOAD(var)        __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+  #define _Q_STORE(var, val)  __atomic_store_n(&(var), (val), __ATOMIC_RELEASE)
+#else
+  // single core targets, volatile keeps the order
+  #define _Q_LOAD(var)        (var)
+  #define _Q_STORE(var, val)  ((var) = (val))
+#endif
+
+/** @enum Recorded operations */
+enum {
+  _Q_RECT,
+  _Q_CLEAR,
+  _Q_PIXEL,
+  _Q_LINE,
+  _Q_GRADIENT,
+  _Q_BITMAP,
+  _Q_STREAM,
+  _Q_STRING_FAST,
+  _Q_CALLBACK,
+  _Q_FENCE
+};
+
+/**
+ * @desc    Returns the slot the producer fills next, NULL if the ring is full
+ *
+ * @param   ili9341_queue_t* q
+ * @param   uint8_t op
+ *
+ * @return  ili9341_qcmd_t*
+ */
+static ili9341_qcmd_t *queueSlot(ili9341_queue_t *q, uint8_t op)
+{
+  ili9341_qcmd_t *cmd;
+
+#ifdef ILI9341_FRAMEBUFFER
+  if (q->frame) {
+    if (q->frame_count >= q->frame_len) {
+      return NULL;
+    }
+    cmd = &q->frame[q->frame_count];
+  } else
+#endif
+  if ((uint8_t) (q->head - _Q_LOAD(q->tail)) >= ILI9341_QUEUE_LEN) {
+    return NULL;
+  } else {
+    cmd = &q->cmds[q->head & (ILI9341_QUEUE_LEN - 1)];
+  }
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->op = op;
+
+  return cmd;
+}
+
+/**
+ * @desc    Hands the filled slot over to the consumer, or adds it to the recorded frame
+ *
+ * @param   ili9341_queue_t* q
+ *
+ * @return  char ILI9341_SUCCESS
+ */
+static char queuePublish(ili9341_queue_t *q)
+{
+#ifdef ILI9341_FRAMEBUFFER
+  if (q->frame) {
+    q->frame_count++;
+    return ILI9341_SUCCESS;
+  }
+#endif
+  _Q_STORE(q->head, (uint8_t) (q->head + 1));
+
+  return ILI9341_SUCCESS;
+}
+
+/**
+ * @desc    Records an operation on a rectangle
+ *
+ * @param   ili9341_queue_t* q
+ * @param   uint8_t op
+ * @param   uint16_t x
+ * @param   uint16_t y
+ * @param   uint16_t w
+ * @param   uint16_t h
+ * @param   uint16_t color
+ *
+ * @return  char
+ */
+static char queueRect(ili9341_queue_t *q, uint8_t op, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+  ili9341_qcmd_t *cmd = queueSlot(q, op);
+
+  if (cmd == NULL) {
+    return ILI9341_ERROR;
+  }
+  cmd->x = x;
+  cmd->y = y;
+  cmd->w = w;
+  cmd->h = h;
+  cmd->color = color;
+
+  return queuePublish(q);
+}
+
+void ili9341_queue_init (ili9341_queue_t *q, ili9341_t *lcd)
+{
+  memset(q, 0, sizeof(*q));
+  q->lcd = lcd;
+}
+
+uint8_t ili9341_queue_free (const ili9341_queue_t *q)
+{
+  return ILI9341_QUEUE_LEN - (uint8_t) (_Q_LOAD(q->head) - _Q_LOAD(q->tail));
+}
+
+bool ili9341_queue_idle (const ili9341_queue_t *q)
+{
+  return _Q_LOAD(q->head) == _Q_LOAD(q->tail);
+}
+
+char ili9341_queue_draw_rect (ili9341_queue_t *q, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+  return queueRect(q, _Q_RECT, x, y, w, h, color);
+}
+
+char ili9341_queue_clear_screen (ili9341_queue_t *q, uint16_t color)
+{
+  return queueRect(q, _Q_CLEAR, 0, 0, 0, 0, color);
+}
+
+char ili9341_queue_draw_pixel (ili9341_queue_t *q, uint16_t x, uint16_t y, uint16_t color)
+{
+  return queueRect(q, _Q_PIXEL, x, y, 0, 0, color);
+}
+
+char ili9341_queue_draw_line (ili9341_queue_t *q, uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, uint16_t color)
+{
+  return queueRect(q, _Q_LINE, x1, y1, x2, y2, color);
+}
+
+char ili9341_queue_draw_gradient_rect (ili9341_queue_t *q, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c0, uint16_t c1, bool horizontal)
+{
+  ili9341_qcmd_t *cmd = queueSlot(q, _Q_GRADIENT);
+
+  if (cmd == NULL) {
+    return ILI9341_ERROR;
+  }
+  cmd->x = x;
+  cmd->y = y;
+  cmd->w = w;
+  cmd->h = h;
+  cmd->color = c0;
+  cmd->bg = c1;
+  cmd->param = horizontal;
+
+  return queuePublish(q);
+}
+
+char ili9341_queue_draw_bitmap (ili9341_queue_t *q, uint16_t x, uint16_t y, const uint8_t *bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565)
+{
+  ili9341_qcmd_t *cmd = queueSlot(q, _Q_BITMAP);
+
+  if (cmd == NULL) {
+    return ILI9341_ERROR;
+  }
+  cmd->x = x;
+  cmd->y = y;
+  cmd->w = w;
+  cmd->h = h;
+  cmd->color = fg565;
+  cmd->bg = bg565;
+  cmd->ptr = bitmap;
+
+  return queuePublish(q);
+}
+
+char ili9341_queue_stream_rect (ili9341_queue_t *q, uint16_t x, uint16_t y, uint16_t w, uint16_t h, ili9341_render_fn render, void *arg)
+{
+  ili9341_qcmd_t *cmd = queueSlot(q, _Q_STREAM);
+
+  if (cmd == NULL) {
+    return ILI9341_ERROR;
+  }
+  cmd->x = x;
+  cmd->y = y;
+  cmd->w = w;
+  cmd->h = h;
+  cmd->fn.render = render;
+  cmd->ptr = arg;
+
+  return queuePublish(q);
+}
+
+char ili9341_queue_draw_string_fast (ili9341_queue_t *q, uint16_t x, uint16_t y, const char *str, uint16_t text_color, uint8_t size, uint16_t bg_color)
+{
+  ili9341_qcmd_t *cmd = queueSlot(q, _Q_STRING_FAST);
+
+  if (cmd == NULL) {
+    return ILI9341_ERROR;
+  }
+  cmd->x = x;
+  cmd->y = y;
+  cmd->color = text_color;
+  cmd->bg = bg_color;
+  cmd->param = size;
+  cmd->ptr = str;
+
+  return queuePublish(q);
+}
+
+char ili9341_queue_callback (ili9341_queue_t *q, ili9341_done_fn done, void *arg)
+{
+  ili9341_qcmd_t *cmd = queueSlot(q, _Q_CALLBACK);
+
+  if (cmd == NULL) {
+    return ILI9341_ERROR;
+  }
+  cmd->fn.done = done;
+  cmd->ptr = arg;
+
+  return queuePublish(q);
+}
+
+char ili9341_queue_fence (ili9341_queue_t *q, ili9341_fence_t *fence)
+{
+  ili9341_qcmd_t *cmd = queueSlot(q, _Q_FENCE);
+
+  if (cmd == NULL) {
+    return ILI9341_ERROR;
+  }
+  cmd->param = ++q->fence_issued;
+  *fence = cmd->param;
+
+  return queuePublish(q);
+}
+
+bool ili9341_queue_fence_done (const ili9341_queue_t *q, ili9341_fence_t fence)
+{
+  return (int8_t) (_Q_LOAD(q->fence_done) - fence) >= 0;
+}
+
+/**
+ * @desc    Executes a recorded command on the instance of the queue
+ *
+ * @param   ili9341_queue_t* q
+ * @param   const ili9341_qcmd_t* cmd
+ *
+ * @return  void
+ */
+static void queueExec(ili9341_queue_t *q, const ili9341_qcmd_t *cmd)
+{
+  ili9341_t *lcd = q->lcd;
+
+  switch (cmd->op) {
+    case _Q_RECT:
+      ili9341_draw_rect(lcd, cmd->x, cmd->y, cmd->w, cmd->h, cmd->color);
+      break;
+    case _Q_CLEAR:
+      ili9341_clear_screen(lcd, cmd->color);
+      break;
+    case _Q_PIXEL:
+      ili9341_draw_pixel(lcd, cmd->x, cmd->y, cmd->color);
+      break;
+    case _Q_LINE:
+      ili9341_draw_line(lcd, cmd->x, cmd->w, cmd->y, cmd->h, cmd->color);
+      break;
+    case _Q_GRADIENT:
+      ili9341_draw_gradient_rect(lcd, cmd->x, cmd->y, cmd->w, cmd->h, cmd->color, cmd->bg, cmd->param);
+      break;
+    case _Q_BITMAP:
+      ili9341_draw_bitmap(lcd, cmd->x, cmd->y, cmd->ptr, cmd->w, cmd->h, cmd->color, cmd->bg);
+      break;
+    case _Q_STREAM:
+      ili9341_stream_rect(lcd, cmd->x, cmd->y, cmd->w, cmd->h, cmd->fn.render, (void *) cmd->ptr);
+      break;
+    case _Q_STRING_FAST:
+      ili9341_set_position(lcd, cmd->x, cmd->y);
+      ili9341_draw_string_fast(lcd, (char *) cmd->ptr, cmd->color, cmd->param, cmd->bg);
+      break;
+    case _Q_CALLBACK:
+      cmd->fn.done((void *) cmd->ptr);
+      break;
+    case _Q_FENCE:
+      // pixels of the commands before are on the panel
+      ili9341_barrier(lcd);
+      _Q_STORE(q->fence_done, cmd->param);
+      break;
+  }
+}
+
+bool ili9341_queue_service (ili9341_queue_t *q)
+{
+  uint8_t tail = q->tail;
+
+  if (tail == _Q_LOAD(q->head)) {
+    return false;
+  }
+  queueExec(q, &q->cmds[tail & (ILI9341_QUEUE_LEN - 1)]);
+  // the slot is read, hand it back
+  _Q_STORE(q->tail, (uint8_t) (tail + 1));
+
+  return true;
+}
+
+uint16_t ili9341_queue_drain (ili9341_queue_t *q, uint16_t max)
+{
+  uint16_t count = 0;
+
+  while ((max == 0 || count < max) && ili9341_queue_service(q)) {
+    count++;
+  }
+  return count;
+}
+
+#ifdef ILI9341_FRAMEBUFFER
+/**
+ * @desc    Rows a recorded command may draw on
+ *
+ * @param   const ili9341_qcmd_t* cmd
+ * @param   uint16_t* ys
+ * @param   uint16_t* ye
+ *
+ * @return  bool false if the command does not draw
+ */
+static bool queueRows(const ili9341_qcmd_t *cmd, uint16_t *ys, uint16_t *ye)
+{
+  switch (cmd->op) {
+    case _Q_RECT:
+    case _Q_GRADIENT:
+    case _Q_BITMAP:
+    case _Q_STREAM:
+      *ys = cmd->y;
+      *ye = cmd->h ? cmd->y + cmd->h - 1 : cmd->y;
+      return true;
+    case _Q_PIXEL:
+      *ys = *ye = cmd->y;
+      return true;
+    case _Q_LINE:
+      *ys = (cmd->y < cmd->h) ? cmd->y : cmd->h;
+      *ye = (cmd->y < cmd->h) ? cmd->h : cmd->y;
+      return true;
+    case _Q_STRING_FAST:
+      // text wraps to the following lines
+      *ys = cmd->y;
+      *ye = ILI9341_SIZE_Y;
+      return true;
+    case _Q_CLEAR:
+      *ys = 0;
+      *ye = ILI9341_SIZE_Y;
+      return true;
+  }
+  return false;
+}
+
+void ili9341_queue_record_frame (ili9341_queue_t *q, ili9341_qcmd_t *cmds, uint16_t len)
+{
+  q->frame = cmds;
+  q->frame_len = cmds ? len : 0;
+  q->frame_count = 0;
+}
+
+uint16_t ili9341_queue_draw_bands (ili9341_queue_t *q, uint8_t *strip, uint16_t rows, uint16_t bg)
+{
+  ili9341_t *lcd = q->lcd;
+  uint16_t strips = 0;
+  uint16_t ys, ye;
+
+  if (q->frame == NULL || strip == NULL || rows == 0) {
+    return 0;
+  }
+  for (uint16_t top=0; top<=ILI9341_SIZE_Y; top+=rows) {
+    uint16_t bottom = ((uint32_t) top + rows - 1 > ILI9341_SIZE_Y) ? ILI9341_SIZE_Y : (uint32_t) top + rows - 1;
+    bool touched = false;
+
+    // replay the frame, skipping what cannot reach the strip (unless scrolling moved the rows)
+    for (uint16_t i=0; i<q->frame_count; i++) {
+      const ili9341_qcmd_t *cmd = &q->frame[i];
+      if (!queueRows(cmd, &ys, &ye) || (!lcd->scroll.off && (ye < top || ys > bottom))) {
+        continue;
+      }
+      if (!touched) {
+        ili9341_attach_strip(lcd, strip, top, bottom, bg);
+        touched = true;
+      }
+      queueExec(q, cmd);
+    }
+    if (touched) {
+      ili9341_flush(lcd);
+      strips++;
+    }
+  }
+  ili9341_attach_framebuffer(lcd, NULL);
+
+  // the frame is drawn, run the callbacks and fences and start the next one
+  for (uint16_t i=0; i<q->frame_count; i++) {
+    if (!queueRows(&q->frame[i], &ys, &ye)) {
+      queueExec(q, &q->frame[i]);
+    }
+  }
+  q->frame_count = 0;
+
+  return strips;
+}
+#endif
@@ -0,0 +1,222 @@
+/**
+ * ---------------------------------------------------------------+
+ * @desc        ILI9341 asynchronous command queue
+ * ---------------------------------------------------------------+
+ *
+ * @file        ili9341_queue.h
+ * @tested      Linux x86-64 (gcc)
+ *
+ * @depend      ili9341
+ * ---------------------------------------------------------------+
+ *
+ * Draw calls are recorded as compact commands in a fixed-size single
+ * producer / single consumer ring and return at once. The consumer - a
+ * transport task, the DMA-complete interrupt or a worker thread - executes
+ * them on the driver instance with ili9341_queue_service(). The producer
+ * never blocks: a call on a full ring returns ILI9341_ERROR and can be
+ * retried later.
+ *
+ * Only the producer writes head and only the consumer writes tail. Both are
+ * single bytes, so they are read and written atomically even on 8-bit
+ * targets, with release / acquire ordering against the command slots.
+ *
+ * Pointers passed to the queue (strings, bitmaps, render arguments) are
+ * read when the command executes, they must stay valid until then (e.g.
+ * until a later fence completes).
+ */
+
+#ifndef __ILI9341_QUEUE_H__
+#define __ILI9341_QUEUE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ili9341.h"
+
+  // Commands the ring holds, a power of two up to 128
+  #ifndef ILI9341_QUEUE_LEN
+    #define ILI9341_QUEUE_LEN     16
+  #endif
+
+  /** @brief Completion callback, runs in the context of the consumer */
+  typedef void (*ili9341_done_fn)(void *arg);
+
+  /** @brief Fence id, compares modulo 256 */
+  typedef uint8_t ili9341_fence_t;
+
+  /** @struct Recorded draw call, members are private to the queue */
+  typedef struct {
+    uint8_t op;
+    uint8_t param;          // text scale, gradient direction, fence id
+    uint16_t x, y, w, h;    // rectangle, line ends or text position
+    uint16_t color, bg;
+    const void *ptr;        // string, bitmap or argument
+    union {
+      ili9341_render_fn render;
+      ili9341_done_fn done;
+    } fn;
+  } ili9341_qcmd_t;
+
+  /** @struct Command ring of one panel */
+  typedef struct {
+    ili9341_t *lcd;
+    ili9341_qcmd_t cmds[ILI9341_QUEUE_LEN];
+    volatile uint8_t head;            // next slot the producer fills
+    volatile uint8_t tail;            // next slot the consumer executes
+    volatile ili9341_fence_t fence_done;  // last fence the consumer passed
+    ili9341_fence_t fence_issued;     // last fence the producer queued
+#ifdef ILI9341_FRAMEBUFFER
+    ili9341_qcmd_t *frame;            // frame recorded instead of the ring, NULL for none
+    uint16_t frame_len;               // commands the frame holds
+    uint16_t frame_count;             // commands recorded
+#endif
+  } ili9341_queue_t;
+
+  /**
+   * @desc    Prepares an empty queue feeding a driver instance
+   *
+   * @param   ili9341_queue_t* q
+   * @param   ili9341_t* lcd
+   *
+   * @return  void
+   */
+  void ili9341_queue_init (ili9341_queue_t *q, ili9341_t *lcd);
+
+  /**
+   * @desc    Number of commands that can be queued without failing
+   *
+   * @param   const ili9341_queue_t* q
+   *
+   * @return  uint8_t
+   */
+  uint8_t ili9341_queue_free (const ili9341_queue_t *q);
+
+  /**
+   * @desc    True if every queued command has been executed
+   *
+   * @param   const ili9341_queue_t* q
+   *
+   * @return  bool
+   */
+  bool ili9341_queue_idle (const ili9341_queue_t *q);
+
+  // PRODUCER
+  // ---------------------------------------------------------------
+  // Same drawing as the ili9341_* function of the same name. Every call returns
+  // ILI9341_SUCCESS, or ILI9341_ERROR if the ring is full and nothing was queued.
+
+  char ili9341_queue_draw_rect (ili9341_queue_t *q, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+  char ili9341_queue_clear_screen (ili9341_queue_t *q, uint16_t color);
+  char ili9341_queue_draw_pixel (ili9341_queue_t *q, uint16_t x, uint16_t y, uint16_t color);
+  char ili9341_queue_draw_line (ili9341_queue_t *q, uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, uint16_t color);
+  char ili9341_queue_draw_gradient_rect (ili9341_queue_t *q, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c0, uint16_t c1, bool horizontal);
+  char ili9341_queue_draw_bitmap (ili9341_queue_t *q, uint16_t x, uint16_t y, const uint8_t *bitmap, uint16_t w, uint16_t h, uint16_t fg565, uint16_t bg565);
+  char ili9341_queue_stream_rect (ili9341_queue_t *q, uint16_t x, uint16_t y, uint16_t w, uint16_t h, ili9341_render_fn render, void *arg);
+
+  /**
+   * @desc    Queues ili9341_set_position followed by ili9341_draw_string_fast
+   *
+   * @param   ili9341_queue_t* q
+   * @param   uint16_t x
+   * @param   uint16_t y
+   * @param   const char* str Read when the command executes
+   * @param   uint16_t text_color
+   * @param   uint8_t size
+   * @param   uint16_t bg_color
+   *
+   * @return  char
+   */
+  char ili9341_queue_draw_string_fast (ili9341_queue_t *q, uint16_t x, uint16_t y, const char *str, uint16_t text_color, uint8_t size, uint16_t bg_color);
+
+  /**
+   * @desc    Queues a callback, called by the consumer once the commands before it were handed to the HAL
+   *
+   * @param   ili9341_queue_t* q
+   * @param   ili9341_done_fn done
+   * @param   void* arg
+   *
+   * @return  char
+   */
+  char ili9341_queue_callback (ili9341_queue_t *q, ili9341_done_fn done, void *arg);
+
+  /**
+   * @desc    Queues a fence. It completes once the commands before it were handed to the HAL and
+   *          the bus is idle (barrier), so their pixels are on the panel.
+   *
+   * @param   ili9341_queue_t* q
+   * @param   ili9341_fence_t* fence Id to poll with ili9341_queue_fence_done()
+   *
+   * @return  char
+   */
+  char ili9341_queue_fence (ili9341_queue_t *q, ili9341_fence_t *fence);
+
+  /**
+   * @desc    True if a fence has completed. At most 127 fences may be outstanding.
+   *
+   * @param   const ili9341_queue_t* q
+   * @param   ili9341_fence_t fence
+   *
+   * @return  bool
+   */
+  bool ili9341_queue_fence_done (const ili9341_queue_t *q, ili9341_fence_t fence);
+
+  // CONSUMER
+  // ---------------------------------------------------------------
+
+  /**
+   * @desc    Executes the oldest queued command
+   *
+   * @param   ili9341_queue_t* q
+   *
+   * @return  bool false if the queue was empty
+   */
+  bool ili9341_queue_service (ili9341_queue_t *q);
+
+  /**
+   * @desc    Executes queued commands until the queue is empty or max commands ran
+   *
+   * @param   ili9341_queue_t* q
+   * @param   uint16_t max 0 for no limit
+   *
+   * @return  uint16_t number of commands executed
+   */
+  uint16_t ili9341_queue_drain (ili9341_queue_t *q, uint16_t max);
+
+#ifdef ILI9341_FRAMEBUFFER
+  // BAND RENDERING
+  // ---------------------------------------------------------------
+  // For targets without RAM for a framebuffer the producer calls can record a whole frame into a command
+  // buffer the caller sizes, which is then drawn one horizontal strip at a time: every strip is filled with
+  // the background, the commands reaching it are replayed into it (pixels outside are dropped) and the
+  // damaged part is sent with a single window and RAMWR. Overdrawn pixels cross the bus once. The panel
+  // outside of the drawn areas is left as is, so inside of the sent area the frame is drawn over bg, not
+  // over what the panel showed before.
+
+  /**
+   * @desc    Records the following producer calls into a frame instead of the ring, a call on a full frame
+   *          returns ILI9341_ERROR. The ring is left as is and can still be serviced.
+   *
+   * @param   ili9341_queue_t* q
+   * @param   ili9341_qcmd_t* cmds frame buffer, NULL to record into the ring again
+   * @param   uint16_t len commands cmds holds
+   *
+   * @return  void
+   */
+  void ili9341_queue_record_frame (ili9341_queue_t *q, ili9341_qcmd_t *cmds, uint16_t len);
+
+  /**
+   * @desc    Draws the recorded frame strip by strip, then runs its callbacks and fences and empties it
+   *          for the next frame. Commands are executed once per strip they reach: the render function of a
+   *          ili9341_queue_stream_rect() is run over the whole rectangle again for every strip and has to
+   *          start over from the first pixel each time (e.g. wrap around after w*h*2 bytes).
+   *
+   * @param   ili9341_queue_t* q
+   * @param   uint8_t* strip ILI9341_STRIP_SIZE(rows) bytes, e.g. 7680 for 240x16
+   * @param   uint16_t rows of a strip
+   * @param   uint16_t bg background of the frame
+   *
+   * @return  uint16_t strips sent, 0 if no frame is recorded
+   */
+  uint16_t ili9341_queue_draw_bands (ili9341_queue_t *q, uint8_t *strip, uint16_t rows, uint16_t bg);
+#endif
+
+#endif